@@ -0,0 +1,167 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <math.h>
+
+#include "Autotune.h"
+
+/* Half the swing of the relay output, which goes between 0 and 1. */
+#define AUTOTUNE_RELAY  0.50
+
+/* sampleTime: seconds between calls to compute() */
+Autotune::Autotune(double sampleTime)
+: _sampleTime(sampleTime), _setpoint(0.00), _hysteresis(0.00),
+  _state(AUTOTUNE_IDLE), _output(false), _samples(0), _lastRise(0),
+  _cycles(0), _max(0.00), _min(0.00), _sumAmplitude(0.00),
+  _sumPeriod(0.00), _ku(0.00), _pu(0.00)
+{
+}
+
+/* hysteresis: how far past the set point the input goes before the relay
+ * switches, which needs to be more than the probe noise. */
+void Autotune::start(double setpoint, double hysteresis)
+{
+  _setpoint = setpoint;
+  _hysteresis = hysteresis;
+
+  _state = AUTOTUNE_RUNNING;
+  _output = true;
+  _samples = 0;
+  _lastRise = 0;
+  _cycles = 0;
+  _sumAmplitude = 0.00;
+  _sumPeriod = 0.00;
+}
+
+void Autotune::stop(void)
+{
+  _state = AUTOTUNE_IDLE;
+  _output = false;
+}
+
+/* Returns the demand, 0 or 1. Called once per sample. */
+double Autotune::compute(double input)
+{
+  if (_state != AUTOTUNE_RUNNING)
+  {
+    return 0.00;
+  }
+
+  _samples++;
+  if ((_samples * _sampleTime) > AUTOTUNE_TIMEOUT)
+  {
+    _state = AUTOTUNE_FAILED;
+    _output = false;
+    return 0.00;
+  }
+
+  if (input > _max)
+  {
+    _max = input;
+  }
+
+  if (input < _min)
+  {
+    _min = input;
+  }
+
+  if (_output && (input > (_setpoint + _hysteresis)))
+  {
+    _output = false;
+  }
+  else if (!_output && (input < (_setpoint - _hysteresis)))
+  {
+    _output = true;
+
+    /* Each rise ends a cycle. The one ending at the first rise is just the
+     * heat-up, and the next is let settle. */
+    if (_lastRise != 0)
+    {
+      if (_cycles > 0)
+      {
+        _sumAmplitude += (_max - _min) / 2.00;
+        _sumPeriod += (_samples - _lastRise) * _sampleTime;
+      }
+
+      if (++_cycles > AUTOTUNE_CYCLES)
+      {
+        finish();
+        return 0.00;
+      }
+    }
+
+    _lastRise = _samples;
+    _max = input;
+    _min = input;
+  }
+
+  return _output ? 1.00 : 0.00;
+}
+
+/* Describing function of a relay with hysteresis. */
+void Autotune::finish(void)
+{
+  double amplitude = _sumAmplitude / AUTOTUNE_CYCLES;
+
+  _output = false;
+
+  if (amplitude <= _hysteresis)
+  {
+    _state = AUTOTUNE_FAILED;
+    return;
+  }
+
+  _ku = (4.00 * AUTOTUNE_RELAY) /
+        (M_PI * sqrt((amplitude * amplitude) - (_hysteresis * _hysteresis)));
+  _pu = _sumPeriod / AUTOTUNE_CYCLES;
+
+  _state = AUTOTUNE_DONE;
+}
+
+unsigned char Autotune::getState(void)
+{
+  return _state;
+}
+
+/* Seconds since the tuner was started. */
+double Autotune::getElapsed(void)
+{
+  return _samples * _sampleTime;
+}
+
+double Autotune::getUltimateGain(void)
+{
+  return _ku;
+}
+
+double Autotune::getUltimatePeriod(void)
+{
+  return _pu;
+}
+
+/* Kc = Ku / 3.2 */
+double Autotune::getKp(void)
+{
+  return _ku / 3.20;
+}
+
+/* Ti = 2.2 Pu */
+double Autotune::getKi(void)
+{
+  return getKp() / (2.20 * _pu);
+}
@@ -0,0 +1,81 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+/* Tuner states. */
+#define AUTOTUNE_IDLE     0
+#define AUTOTUNE_RUNNING  1
+#define AUTOTUNE_DONE     2
+#define AUTOTUNE_FAILED   3
+
+/* Oscillations measured, after a first one that is let settle. */
+#define AUTOTUNE_CYCLES  3
+
+/* Give up if the oscillation hasn't been measured by then. */
+#define AUTOTUNE_TIMEOUT  (6.00 * 60.00 * 60.00) // s
+
+/* Relay autotuner. The element is switched fully on below the set point
+ * and off above it, with some hysteresis, and the resulting oscillation
+ * gives the ultimate gain and period of the plant. PI gains are derived
+ * from these with the Tyreus-Luyben rules, which overshoot less than
+ * Ziegler-Nichols. There is no derivative gain: on readings in 1/16C steps
+ * it would mostly amplify the steps. */
+class Autotune
+{
+  public:
+    Autotune(double sampleTime);
+
+    void start(double setpoint, double hysteresis);
+    void stop(void);
+
+    double compute(double input);
+
+    unsigned char getState(void);
+    double getElapsed(void);
+
+    double getUltimateGain(void);
+    double getUltimatePeriod(void);
+    double getKp(void);
+    double getKi(void);
+
+  private:
+    void finish(void);
+
+    double _sampleTime;
+    double _setpoint;
+    double _hysteresis;
+
+    unsigned char _state;
+    bool _output;
+
+    unsigned long _samples;
+    unsigned long _lastRise;
+    unsigned char _cycles;
+
+    double _max;
+    double _min;
+    double _sumAmplitude;
+    double _sumPeriod;
+
+    double _ku;
+    double _pu;
+};
+
+#endif
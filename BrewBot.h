@@ -20,27 +20,84 @@
 #define BREWBOT_H
 
 #include <LiquidCrystal.h>
-#include <AnalogButtons.h>
 #include <OneWire.h>
 #include <DallasTemperature.h>
-#include <PID_v1.h>
 
 #include <DeviceManager.h>
 
 #include <Device.h>
 #include <BooleanDevice.h>
-#include <DutyCycleDevice.h>
-#include <OneWireTemperatureDevice.h>
-#include <PidRelayDevice.h>
-#include <ShiftRegisterDevice.h>
-#include <ShiftBitDevice.h>
 
 #include "constants.h"
 #include "pins.h"
+#include "Probes.h"
+#include "Pid.h"
+#include "Modulator.h"
+#include "ZeroCross.h"
+#include "PowerArbiter.h"
+#include "Autotune.h"
+#include "Plant.h"
+#include "Scheduler.h"
+#include "Profiler.h"
+#include "EventLog.h"
+#include "RelayRegister.h"
+#include "ParallelBackend.h"
+#include "I2CBackend.h"
+#include "TerminalBackend.h"
+
+/* Profiled stages of the main loop. */
+#define PROFILE_LOOP       0
+#define PROFILE_SCHEDULER  1
+#define PROFILE_SENSORS    2
+#define PROFILE_CONTROL    3
+#define PROFILE_UI         4
+#define PROFILE_RELAYS     5
+#define PROFILE_JITTER     6 // How late each control pass started
+#define PROFILE_IDLE       7 // Whole passes that had no task due
+#define NUM_PROFILES       8
+
+/* Event log ids. */
+#define EVENT_RIMS_DEMAND  2 // In 1/MODULATOR_SCALE
+#define EVENT_BK_DEMAND    4
+#define EVENT_STEP_DONE    5 // (function << 8) | step, then the two below
+#define EVENT_STEP_RAMP    6 // Timer minutes out of band
+#define EVENT_STEP_HOLD    7 // Timer minutes in band
+
+/* Target of a probe nothing is controlling. */
+#define PROBE_NO_TARGET  (-32767)
+
+/* Consumers of probe readings. A probe is only read while it has one. */
+#define PROBE_USER_UI    (1 << 0)
+#define PROBE_USER_PID   (1 << 1)
+#define PROBE_USER_TUNE  (1 << 2)
+
+/* Heated vessels. */
+#define VESSEL_RIMS  0
+#define VESSEL_BK    1
+#define VESSEL_NONE  (-1)
+#define NUM_VESSELS  2
+
+/* Lines of the 'p' report, written one at a time as the serial TX buffer
+ * has room, after the profiler's dump. */
+#define REPORT_NONE       0
+#define REPORT_PROFILE    1
+#define REPORT_DROPPED    2
+#define REPORT_BUS        3
+#define REPORT_RIMS       4
+#define REPORT_BK         5
+#define REPORT_LATE       6
+#define REPORT_LINE_SIZE  40 // Longest line, with its number and CRLF
+
+/* PID gains kept in EEPROM, one slot per function and temperature band. */
+#define GAINS_MAGIC      0xC3
+#define GAINS_SLOT_SIZE  16
+#define GAINS_FUNCTIONS  5 // One per UI function
+#define GAINS_BANDS      3
+#define GAINS_BAND_MID   (60 * TEMP_ONE) // Dough-in and protein rests below
+#define GAINS_BAND_HIGH  (85 * TEMP_ONE) // Boil and near-boil holds from
 
-double getProbeRIMSTemp(void);
 void setElementRIMS(bool value);
-bool requestTemperatures(void);
+void setElementBK(bool value);
 
 class BrewBot
 {
@@ -48,41 +105,143 @@ class BrewBot
     BrewBot();
 
     void setup(void);
-    bool requestTemperatures(void);
-
-    /* Probe addresses. */
-    DeviceAddress addrProbeRIMS;
-    DeviceAddress addrProbeBK;
+    void start(void);
+    void halt(const __FlashStringHelper *reason);
+    void control(void);
+    void flushRelays(void);
+    void computePids(void);
+
+    void startTune(int vessel, int temp);
+    void stopTune(void);
+
+    struct gains
+    {
+      float kp;
+      float ki;
+      float kd;
+    };
+
+    static unsigned int getGainBand(int temp);
+    bool loadGains(unsigned int function, unsigned int band, gains *g);
+    void saveGains(unsigned int function, unsigned int band,
+                   const gains *g);
+    void scheduleGains(int vessel, unsigned int function, int temp);
+    void startReport(void);
+    void report(HardwareSerial *out);
+    void printPidCycles(Print *out);
+    void resetShortfall(void);
+    void requestTemperatures(void);
+    void collectTemperature(void);
+
+    int getProbeTemp(unsigned int probe);
+    void setProbeTarget(unsigned int probe, int target);
+
+    void subscribeProbe(unsigned int probe, uint8_t user);
+    void unsubscribeProbe(unsigned int probe, uint8_t user);
+
+    unsigned long getBusSaved(void);
+    void resetBusStats(void);
+
+    Scheduler scheduler;
+    Profiler profiler;
+    EventLog eventLog;
 
     /* Temperature sensors. */
     OneWire oneWire;
     DallasTemperature sensors;
+    Probes probes;
+
+#if SIMULATE_PLANT
+    /* Simulated vessels. */
+    Plant plantRIMS;
+    Plant plantBK;
 
-    OneWireTemperatureDevice devProbeRIMS;
-    OneWireTemperatureDevice devProbeBK;
+    void updatePlants(void);
+#endif
+
+    /* Display. */
+#if DISPLAY_BACKEND == DISPLAY_I2C
+    I2CBackend lcd;
+#elif DISPLAY_BACKEND == DISPLAY_TERMINAL
+    TerminalBackend lcd;
+#else
+    ParallelBackend lcd;
+#endif
 
     /* Indicator devices. */
     BooleanDevice devIndicator;
     BooleanDevice devBeeper;
 
-    /* PID devices. */
-    PidRelayDevice devPIDRIMS;
-    PidRelayDevice devPIDBK;
+    /* PIDs. */
+    Pid pidRIMS;
+    Pid pidBK;
 
     /* Relay devices. */
-    ShiftRegisterDevice devRelays;
-    ShiftBitDevice devElementControl;
-    ShiftBitDevice devElementRIMS;
-    ShiftBitDevice devElementBK;
-    ShiftBitDevice devPump;
-    ShiftBitDevice devFan;
-
-    /* Duty cycle devices. */
-    DutyCycleDevice devElementRIMSDC;
-    DutyCycleDevice devElementBKDC;
+    RelayRegister devRelays;
+    RelayBit devElementControl;
+    RelayBit devElementRIMS;
+    RelayBit devElementBK;
+    RelayBit devPump;
+    RelayBit devFan;
+
+    /* Element output. */
+    ZeroCross zeroCross;
+    Modulator modRIMS;
+    Modulator modBK;
+    PowerArbiter arbiter;
+
+    /* PID autotuner, for one vessel at a time. */
+    Autotune autotune;
 
   private:
-    unsigned long _nextTickSensor;
+    static void tickSensor(void *cookie);
+    static void tickConversion(void *cookie);
+
+    double computeDemand(int vessel, Pid *pid, int temp);
+
+    unsigned int nextProbe(void);
+    uint8_t selectResolution(unsigned int probe);
+    unsigned long conversionTime(unsigned int probe);
+
+    unsigned long _controlDeadline;
+    unsigned int _controlPasses;
+    unsigned long _lateHalfCycles;
+
+    unsigned int _reportLine;
+
+    unsigned int _lastDemandRIMS;
+    unsigned int _lastDemandBK;
+
+    int _loadRIMS;
+    int _loadBK;
+
+    int _tuneVessel;
+
+    /* Function and band each vessel's gains were last scheduled for. */
+    unsigned int _gainsFunction[NUM_VESSELS];
+    unsigned int _gainsBand[NUM_VESSELS];
+
+    int _taskSensor;
+    int _taskConversion;
+
+    unsigned int _sensorProbe;
+    unsigned int _pendingProbes;
+    unsigned long _conversionStart;
+
+    int _probeTemp[NUM_PROBES];
+    int _probeTarget[NUM_PROBES];
+    uint8_t _probeUsers[NUM_PROBES];
+
+    /* Scratchpad reads done and skipped, for getBusSaved(). */
+    unsigned long _busTime;
+    unsigned long _busReads;
+    unsigned long _busSkipped;
+    unsigned long _busStart;
+
+#if SIMULATE_PLANT
+    Plant *_probePlant[NUM_PROBES];
+    unsigned long _lastTickPlant;
+#endif
 };
 
 #endif
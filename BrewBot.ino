@@ -23,311 +23,1057 @@
 #endif
 
 #include <LiquidCrystal.h>
-#include <AnalogButtons.h>
+#include <EEPROM.h>
 #include <OneWire.h>
 #include <DallasTemperature.h>
-#include <PID_v1.h>
 
 #include <DeviceManager.h>
 
 #include <Device.h>
 #include <BooleanDevice.h>
-#include <DutyCycleDevice.h>
-#include <OneWireTemperatureDevice.h>
-#include <PidRelayDevice.h>
-#include <ShiftRegisterDevice.h>
-#include <ShiftBitDevice.h>
 
 #include "constants.h"
 #include "pins.h"
+#include "Probes.h"
+#include "Pid.h"
+#include "Modulator.h"
+#include "ZeroCross.h"
+#include "PowerArbiter.h"
+#include "Autotune.h"
+#include "Plant.h"
+#include "Scheduler.h"
+#include "Profiler.h"
+#include "EventLog.h"
+#include "RelayRegister.h"
+#include "ParallelBackend.h"
+#include "I2CBackend.h"
+#include "TerminalBackend.h"
 #include "UI.h"
 #include "BrewBot.h"
 
+const char * const profileNames[NUM_PROFILES] =
+{
+  "loop", "scheduler", "sensors", "control", "ui", "relays", "jitter", "idle"
+};
+
 BrewBot::BrewBot()
-: oneWire(PIN_ONE_WIRE),
+: profiler(profileNames, NUM_PROFILES),
+  oneWire(PIN_ONE_WIRE),
   sensors(&oneWire),
-  addrProbeRIMS({ 0x28, 0xB5, 0x7E, 0x57, 0x04, 0x00, 0x00, 0xFD }),
-  addrProbeBK({ 0x28, 0x40, 0xDA, 0xAA, 0x02, 0x00, 0x00, 0x75 }),
-  devProbeRIMS(&sensors, addrProbeRIMS),
-  devProbeBK(&sensors, addrProbeBK),
-  devPIDRIMS(getProbeRIMSTemp, setElementRIMSDC, 1.0, 1.0, 1.0),
-  devPIDBK(getProbeBKTemp, setElementBKDC, 1.0, 1.0, 1.0),
+  probes(&oneWire, &sensors),
+#if SIMULATE_PLANT
+  plantRIMS(PLANT_AMBIENT, PLANT_RIMS_POWER, PLANT_RIMS_MASS, PLANT_RIMS_LOSS,
+            PLANT_AMBIENT, PLANT_BOIL, PLANT_RIMS_DEAD),
+  plantBK(PLANT_AMBIENT, PLANT_BK_POWER, PLANT_BK_MASS, PLANT_BK_LOSS,
+          PLANT_AMBIENT, PLANT_BOIL, PLANT_BK_DEAD),
+#endif
+#if DISPLAY_BACKEND == DISPLAY_I2C
+  lcd(LCD_I2C_ADDRESS),
+#elif DISPLAY_BACKEND == DISPLAY_TERMINAL
+  lcd(&Serial),
+#else
+  lcd(PIN_LCD_RS, PIN_LCD_ENABLE, PIN_LCD_D0, PIN_LCD_D1, PIN_LCD_D2, PIN_LCD_D3),
+#endif
+  devIndicator(PIN_INDICATOR, false, true),
+  devBeeper(PIN_BEEPER, false, true),
+  pidRIMS(PID_RIMS_KP, PID_RIMS_KI, PID_RIMS_KD, PID_TIME / 1000.00),
+  pidBK(PID_BK_KP, PID_BK_KI, PID_BK_KD, PID_TIME / 1000.00),
+#if RELAY_MODE == RELAY_SPI
+  devRelays(PIN_RELAY_LATCH, 0),
+#else
   devRelays(PIN_RELAY_CLOCK, PIN_RELAY_LATCH, PIN_RELAY_DATA, 0),
+#endif
   devElementControl(&devRelays, 1, false),
   devElementRIMS(&devRelays, 2, false),
   devElementBK(&devRelays, 3, false),
   devPump(&devRelays, 4, false),
   devFan(&devRelays, 5, false),
-  devElementRIMSDC(setElementRIMS, 360, 60),
-  devElementBKDC(setElementBK, 360, 60),
-  devIndicator(PIN_INDICATOR, false, true),
-  devBeeper(PIN_BEEPER, false, true)
+  zeroCross(PIN_ZERO_CROSS, MAINS_HZ),
+  modRIMS(ELEMENT_MODULATION, ELEMENT_WINDOW, ELEMENT_STEPS),
+  modBK(ELEMENT_MODULATION, ELEMENT_WINDOW, ELEMENT_STEPS),
+  arbiter(POWER_LIMIT),
+  autotune(PID_TIME / 1000.00),
+  _controlDeadline(0),
+  _controlPasses(0),
+  _lateHalfCycles(0),
+  _reportLine(REPORT_NONE),
+  _lastDemandRIMS(0),
+  _lastDemandBK(0),
+  _tuneVessel(VESSEL_NONE),
+  _sensorProbe(0),
+  _pendingProbes(0),
+  _conversionStart(0),
+  _busTime(0),
+  _busReads(0),
+  _busSkipped(0),
+  _busStart(0)
+#if SIMULATE_PLANT
+  , _lastTickPlant(0)
+#endif
 {
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    _probeTemp[i] = DEVICE_DISCONNECTED_C * TEMP_ONE;
+    _probeTarget[i] = PROBE_NO_TARGET;
+    _probeUsers[i] = 0;
+  }
+
+  for (unsigned int i = 0; i < NUM_VESSELS; i++)
+  {
+    _gainsFunction[i] = GAINS_FUNCTIONS;
+    _gainsBand[i] = GAINS_BANDS;
+  }
+
+#if SIMULATE_PLANT
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    _probePlant[i] = NULL;
+  }
+
+  _probePlant[PROBE_RIMS] = &plantRIMS;
+  _probePlant[PROBE_BK] = &plantBK;
+#endif
 }
 
 void BrewBot::setup()
 {
-  /* Setup temperature sensors. */
+  /* Setup temperature sensors. This also finds out whether any are on
+   * parasite power. */
   sensors.begin();
-  for (uint8_t i = 0; i < sensors.getDeviceCount(); i++)
-  {
-    DeviceAddress tempDeviceAddress;
 
-    /* Search the wire for address. */
-    if (sensors.getAddress(tempDeviceAddress, i))
-    {
-      sensors.setResolution(tempDeviceAddress, TEMPERATURE_PRECISION);
-    }
-  }
+  /* Bind the temperature sensors to their roles. */
+  probes.setup();
+
+  /* Conversions are collected from the loop rather than waited on. */
+  sensors.setWaitForConversion(false);
+
+  _taskSensor = scheduler.addTask(tickSensor, this, SENSOR_TIME);
+  _taskConversion = scheduler.addTask(tickConversion, this, 0);
 
   /* Setup devices. */
   unsigned int devID = 0;
   devIndicator.Setup(devID++);
   devBeeper.Setup(devID++);
-  devProbeRIMS.Setup(devID++);
-  devProbeBK.Setup(devID++);
-  devPIDRIMS.Setup(devID++);
-  devPIDBK.Setup(devID++);
-  devRelays.Setup(devID++);
-  devElementControl.Setup(devID++);
-  devElementRIMS.Setup(devID++);
-  devElementBK.Setup(devID++);
-  devPump.Setup(devID++);
-  devFan.Setup(devID++);
-  devElementRIMSDC.Setup(devID++);
-  devElementBKDC.Setup(devID++);
+
+  /* Setup relays. */
+  devRelays.setup();
+
+  /* Without these no probe is ever read, so don't go on. */
+  if ((_taskSensor == SCHEDULER_NO_TASK) ||
+      (_taskConversion == SCHEDULER_NO_TASK))
+  {
+    halt(F("sensor tasks: raise SCHEDULER_MAX_TASKS"));
+  }
+
+  scheduler.start(_taskSensor, 0);
+
+  /* Setup element output. */
+  zeroCross.setup();
+  _loadRIMS = arbiter.addLoad(ELEMENT_RIMS_POWER);
+  _loadBK = arbiter.addLoad(ELEMENT_BK_POWER);
+
+  /* Ramp rates are per timer minute, the PIDs want them per second. */
+  pidRIMS.setRamp(RAMP_RIMS * 1000.00 / TIMER_TIME);
+  pidBK.setRamp(RAMP_BK * 1000.00 / TIMER_TIME);
 
 #if 1
-  devPIDRIMS.Write(512.00);
-  devPIDRIMS.enable(true);
+  pidRIMS.setSetpoint(UI_TEMP_DEFAULT);
+  pidRIMS.enable(true);
+  subscribeProbe(PROBE_RIMS, PROBE_USER_PID);
 #endif
 }
 
-bool BrewBot::requestTemperatures()
+/* Start control passes from now. */
+void BrewBot::start(void)
 {
-  unsigned long now = millis();
-  bool updated = false;
+  _controlDeadline = micros();
+}
+
+/* Stop for good with every relay off, after saying why on the serial
+ * port. For faults found at start-up that leave nothing safe to run. */
+void BrewBot::halt(const __FlashStringHelper *reason)
+{
+  devElementControl.Write(false);
+  devElementRIMS.Write(false);
+  devElementBK.Write(false);
+  devPump.Write(false);
+  devFan.Write(false);
+  devRelays.flush();
+
+  Serial.print(F("halted: "));
+  Serial.println(reason);
 
-  if (now >= _nextTickSensor)
+  for (;;)
   {
-    sensors.requestTemperatures();
-    _nextTickSensor = now + SENSOR_TIME;
+  }
+}
+
+/* Step the elements every half-cycle, then service the devices and PIDs
+ * if a control period is due. This is called between each piece of
+ * background work in the loop, so the elements are switched on time however
+ * busy the UI is. */
+void BrewBot::control(void)
+{
+  uint8_t halfCycles = zeroCross.poll();
+
+  if (halfCycles != 0)
+  {
+    /* Zero-cross SSRs switch at the next crossing, so the element states
+     * only need to be latched before then. Only the coming half-cycle can
+     * still be switched; any others since the last poll have gone by with
+     * the elements as they were, so they are counted as late rather than
+     * stepped through. The arbiter keeps both elements within what the
+     * circuit can carry. */
+    unsigned int want = 0;
+
+    _lateHalfCycles += halfCycles - 1;
+
+    if (modRIMS.step())
+    {
+      want |= (1 << _loadRIMS);
+    }
+
+    if (modBK.step())
+    {
+      want |= (1 << _loadBK);
+    }
+
+    unsigned int on = arbiter.step(want);
 
-    updated = true;
+    setElementRIMS(on & (1 << _loadRIMS));
+    setElementBK(on & (1 << _loadBK));
+
+    flushRelays();
   }
 
-  return updated;
-}
+  unsigned long now = micros();
 
-/* Other stuff */
-BrewBot brewBot = BrewBot();
-UI ui = UI(&brewBot);
+  if (!Scheduler::isDue(now, _controlDeadline))
+  {
+    return;
+  }
 
-/* Core setup function. */
-void setup(void)
-{
-  /* Setup the debug LED. */
-  pinMode(PIN_DEBUG_LED, OUTPUT);
+  profiler.record(PROFILE_JITTER, now - _controlDeadline);
 
-  /* Start serial port. */
-  Serial.begin(9600);
-  Serial.println("BrewBot");
+  /* Fixed rate, but don't try to catch up on missed periods. */
+  _controlDeadline += CONTROL_TIME;
+  if (Scheduler::isDue(now, _controlDeadline))
+  {
+    _controlDeadline = now + CONTROL_TIME;
+  }
 
-  /* Setup BrewBot. */
-  brewBot.setup();
+  profiler.begin(PROFILE_CONTROL);
+  DeviceManager::TickAll();
 
-  /* Setup UI. */
-  ui.setup();
+  if (++_controlPasses >= (PID_TIME * 1000UL) / CONTROL_TIME)
+  {
+    _controlPasses = 0;
+    computePids();
+  }
+  profiler.end(PROFILE_CONTROL);
+
+  flushRelays();
 }
 
-void loop(void)
+/* Feed the PIDs' demand to the element modulators. A missing probe turns
+ * its element off rather than reading as very cold. */
+void BrewBot::computePids(void)
 {
-#if 0
-  DeviceManager::ProcessMessages();
-#endif
+  unsigned int demand;
 
-  brewBot.requestTemperatures();
-  DeviceManager::TickAll();
+  modRIMS.setDemand(computeDemand(VESSEL_RIMS, &pidRIMS,
+                                  getProbeTemp(PROBE_RIMS)));
+  modBK.setDemand(computeDemand(VESSEL_BK, &pidBK, getProbeTemp(PROBE_BK)));
 
-#if 0
-  DeviceManager::ReportStatusUpdates();
-#endif
+  /* An element that is no longer wanted mustn't be left to work off what
+   * the arbiter still owes it. */
+  demand = modRIMS.getDemand();
+  if (demand == 0)
+  {
+    arbiter.cancel(_loadRIMS);
+  }
 
-  /* Now let the UI have a turn to run. */
-  ui.loop();
-}
+  if (demand != _lastDemandRIMS)
+  {
+    eventLog.log(EVENT_RIMS_DEMAND, demand);
+    _lastDemandRIMS = demand;
+  }
 
+  demand = modBK.getDemand();
+  if (demand == 0)
+  {
+    arbiter.cancel(_loadBK);
+  }
 
-bool rims_old_value = false;
+  if (demand != _lastDemandBK)
+  {
+    eventLog.log(EVENT_BK_DEMAND, demand);
+    _lastDemandBK = demand;
+  }
+}
 
-double getProbeRIMSTemp()
+/* Demand for one vessel, from its PID or from the autotuner if it is
+ * being tuned. Tuned gains are left for whoever started the tune to save,
+ * which puts them to use. */
+double BrewBot::computeDemand(int vessel, Pid *pid, int temp)
 {
-  static unsigned long nextTick = 0;
-  static double output = 0;
-  static double temp = 45;
-  unsigned long now = millis();
+  if (temp == DEVICE_DISCONNECTED_C * TEMP_ONE)
+  {
+    return 0.00;
+  }
 
-  if (now >= nextTick)
+  if (vessel != _tuneVessel)
   {
-#if 0
-    /* Read in temperature. */
-    double temp = devProbeRIMS.Read();
-#else
-    if (rims_old_value)
+    return pid->compute(temp);
+  }
+
+  double demand = autotune.compute(temp);
+
+  switch (autotune.getState())
+  {
+    case AUTOTUNE_DONE:
+    case AUTOTUNE_FAILED:
     {
-      temp += 0.5;
+      _tuneVessel = VESSEL_NONE;
+      break;
     }
-    else
+
+    default:
+      break;
+  }
+
+  return demand;
+}
+
+/* Autotune a vessel around temp. Its PID must be off. */
+void BrewBot::startTune(int vessel, int temp)
+{
+  unsigned int probe = (vessel == VESSEL_RIMS) ? PROBE_RIMS : PROBE_BK;
+
+  stopTune();
+
+  subscribeProbe(probe, PROBE_USER_TUNE);
+  setProbeTarget(probe, temp);
+
+  autotune.start(temp, AUTOTUNE_HYSTERESIS);
+  _tuneVessel = vessel;
+}
+
+/* Stop tuning. The result, if any, is left in autotune. */
+void BrewBot::stopTune(void)
+{
+  if (autotune.getState() == AUTOTUNE_RUNNING)
+  {
+    autotune.stop();
+  }
+
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    if (_probeUsers[i] & PROBE_USER_TUNE)
     {
-      temp -= 0.5;
+      unsubscribeProbe(i, PROBE_USER_TUNE);
+      setProbeTarget(i, PROBE_NO_TARGET);
     }
-#endif
+  }
 
-    /* Adjust temperature to be in the range of the PID. */
-#if 1
-    double normalised = temp / (UI_TEMP_MAX - UI_TEMP_MIN);
-#else
-    double normalised = temp / 120;
-#endif
+  _tuneVessel = VESSEL_NONE;
+}
 
-    output = normalised * PID_MAX;
+/* Temperature band a set point falls in, for picking gains. */
+unsigned int BrewBot::getGainBand(int temp)
+{
+  if (temp < GAINS_BAND_MID)
+  {
+    return 0;
+  }
+  else if (temp < GAINS_BAND_HIGH)
+  {
+    return 1;
+  }
 
-    nextTick = now + SENSOR_TIME;
+  return 2;
+}
 
-#if 0
-    Serial.print("RIMS temp: ");
-    Serial.println(temp);
-#endif
+/* Each slot is the magic, the gains, then their CRC. */
+bool BrewBot::loadGains(unsigned int function, unsigned int band, gains *g)
+{
+  uint8_t *bytes = (uint8_t *)(g);
+  int addr = EEPROM_GAINS +
+             (((function * GAINS_BANDS) + band) * GAINS_SLOT_SIZE);
+
+  if (EEPROM.read(addr++) != GAINS_MAGIC)
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < sizeof(gains); i++)
+  {
+    bytes[i] = EEPROM.read(addr++);
   }
 
-  return output;
+  return (EEPROM.read(addr) == OneWire::crc8(bytes, sizeof(gains)));
 }
 
-void setElementRIMS(bool value)
+void BrewBot::saveGains(unsigned int function, unsigned int band,
+                        const gains *g)
 {
-  if (rims_old_value != value)
+  const uint8_t *bytes = (const uint8_t *)(g);
+  int addr = EEPROM_GAINS +
+             (((function * GAINS_BANDS) + band) * GAINS_SLOT_SIZE);
+
+  EEPROM.update(addr++, GAINS_MAGIC);
+
+  for (unsigned int i = 0; i < sizeof(gains); i++)
   {
-    if (value)
-    {
-      Serial.println("RIMS on");
-    }
-    else
+    EEPROM.update(addr++, bytes[i]);
+  }
+
+  EEPROM.update(addr, OneWire::crc8(bytes, sizeof(gains)));
+
+  /* A PID already running on this slot picks the new gains up now rather
+   * than at its next step. */
+  for (int vessel = 0; vessel < NUM_VESSELS; vessel++)
+  {
+    Pid *pid = (vessel == VESSEL_RIMS) ? &pidRIMS : &pidBK;
+
+    if ((_gainsFunction[vessel] == function) && (_gainsBand[vessel] == band) &&
+        pid->isEnabled())
     {
-      Serial.println("RIMS off");
+      pid->setTunings(g->kp, g->ki, g->kd);
     }
+  }
+}
 
-#if 0
-    brewBot.devElementRIMS.Write(value);
-#endif
+/* Put a vessel's PID on the gains saved for a function at a set point, or
+ * on the vessel's defaults if none have been saved. */
+void BrewBot::scheduleGains(int vessel, unsigned int function, int temp)
+{
+  Pid *pid = (vessel == VESSEL_RIMS) ? &pidRIMS : &pidBK;
+  unsigned int band = getGainBand(temp);
+  gains g;
 
-    rims_old_value = value;
+  _gainsFunction[vessel] = function;
+  _gainsBand[vessel] = band;
+
+  if (loadGains(function, band, &g))
+  {
+    pid->setTunings(g.kp, g.ki, g.kd);
+  }
+  else if (vessel == VESSEL_RIMS)
+  {
+    pid->setTunings(PID_RIMS_KP, PID_RIMS_KI, PID_RIMS_KD);
+  }
+  else
+  {
+    pid->setTunings(PID_BK_KP, PID_BK_KI, PID_BK_KD);
   }
 }
 
-void setElementRIMSDC(bool value)
+/* Begin a report of the loop's timing, then the events dropped, the probe
+ * bus time saved, how much of the power each element asked for it didn't
+ * get, and how many half-cycles went by before the loop got round to
+ * switching them. */
+void BrewBot::startReport(void)
 {
-  static bool old_value = false;
+  profiler.startDump();
+  _reportLine = REPORT_PROFILE;
+}
 
-  if (old_value != value)
+/* Write the next lines of the report, as many as the serial TX buffer has
+ * room for, so it never holds up the loop. */
+void BrewBot::report(HardwareSerial *out)
+{
+  while (_reportLine != REPORT_NONE)
   {
-    if (value)
+    if (_reportLine == REPORT_PROFILE)
     {
-      Serial.println("RIMS DC on");
+      if (profiler.dump(out))
+      {
+        return;
+      }
     }
-    else
+    else if (out->availableForWrite() < REPORT_LINE_SIZE)
     {
-      Serial.println("RIMS DC off");
+      return;
     }
 
-#if 1
-    brewBot.devElementRIMSDC.Write(value);
+    switch (_reportLine)
+    {
+      case REPORT_DROPPED:
+      {
+#if DISPLAY_BACKEND != DISPLAY_TERMINAL
+        out->print(F("events dropped: "));
+        out->println(eventLog.getDropped());
 #endif
+        break;
+      }
+
+      case REPORT_BUS:
+      {
+        out->print(F("probe bus saved (us/min): "));
+        out->println(getBusSaved());
+        break;
+      }
+
+      case REPORT_RIMS:
+      {
+        out->print(F("RIMS shortfall (%): "));
+        out->println(arbiter.getShortfall(_loadRIMS));
+        break;
+      }
+
+      case REPORT_BK:
+      {
+        out->print(F("BK shortfall (%): "));
+        out->println(arbiter.getShortfall(_loadBK));
+        break;
+      }
+
+      case REPORT_LATE:
+      {
+        out->print(F("late half-cycles: "));
+        out->println(_lateHalfCycles);
+        _reportLine = REPORT_NONE;
+        continue;
+      }
+    }
 
-    old_value = value;
+    _reportLine++;
   }
 }
 
-bool bk_old_value = false;
+/* Cycles per pass from a raw probe reading to a PID input, as it is now
+ * and as it was with getTempC() and the scaling into 0 to 1024, then for a
+ * compute() on a copy of the RIMS PID. Each is run PID_TIME_COUNT times, as
+ * one pass is too quick for micros(). */
+void BrewBot::printPidCycles(Print *out)
+{
+  volatile int16_t raw = (UI_TEMP_DEFAULT << TEMP_RAW_SHIFT);
+  volatile double input;
+  Pid pid = pidRIMS;
+  unsigned long start;
+  unsigned long fixed;
+  unsigned long floating;
+  unsigned long compute;
+
+  start = micros();
+  for (unsigned int i = 0; i < PID_TIME_COUNT; i++)
+  {
+    input = raw >> TEMP_RAW_SHIFT;
+  }
+  fixed = micros() - start;
+
+  start = micros();
+  for (unsigned int i = 0; i < PID_TIME_COUNT; i++)
+  {
+    input = ((raw * 0.0078125F) / 120.00F) * 1024.00;
+  }
+  floating = micros() - start;
+
+  pid.enable(true);
+
+  start = micros();
+  for (unsigned int i = 0; i < PID_TIME_COUNT; i++)
+  {
+    input = pid.compute(raw >> TEMP_RAW_SHIFT);
+  }
+  compute = micros() - start;
 
-double getProbeBKTemp()
+  /* Only there so the loops aren't optimised away. */
+  (void)(input);
+
+  out->print(F("probe to PID, fixed (cycles): "));
+  out->println((fixed * (F_CPU / 1000000UL)) / PID_TIME_COUNT);
+
+  out->print(F("probe to PID, double (cycles): "));
+  out->println((floating * (F_CPU / 1000000UL)) / PID_TIME_COUNT);
+
+  out->print(F("PID compute (cycles): "));
+  out->println((compute * (F_CPU / 1000000UL)) / PID_TIME_COUNT);
+}
+
+void BrewBot::resetShortfall(void)
 {
-  static unsigned long nextTick = 0;
-  static double output = 0;
-  static double temp = 45;
-  unsigned long now = millis();
+  arbiter.reset();
+  _lateHalfCycles = 0;
+}
 
-  if (now >= nextTick)
+/* Latch everything the relays have been asked to do at once. Only flushes
+ * that send a frame are timed. */
+void BrewBot::flushRelays(void)
+{
+  profiler.begin(PROFILE_RELAYS);
+  if (devRelays.flush())
   {
-#if 0
-    /* Read in temperature. */
-    double temp = devProbeBK.Read();
+    profiler.end(PROFILE_RELAYS);
+  }
+}
+
+/* Start a conversion on all probes at once with a skip-ROM command, but
+ * don't wait for it. Each probe is first set to the resolution its distance
+ * from target calls for, and is collected as soon as its own conversion is
+ * done, so the coarse ones don't wait on the fine ones. More probes cost no
+ * more conversion time, and probes nothing is subscribed to cost no bus time
+ * at all. They still convert, so are left at the coarsest resolution to be
+ * done soonest. */
+void BrewBot::requestTemperatures()
+{
+  _pendingProbes = 0;
+
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+#if SIMULATE_PLANT
+    if (_probePlant[i] != NULL)
 #else
-    if (bk_old_value)
+    if (probes.isBound(i))
+#endif
     {
-      temp += 0.5;
+      if (_probeUsers[i] == 0)
+      {
+        probes.setResolution(i, 9);
+        _busSkipped++;
+        continue;
+      }
+
+      probes.setResolution(i, selectResolution(i));
+      _pendingProbes |= (1 << i);
     }
-    else
+  }
+
+  if (_pendingProbes == 0)
+  {
+    return;
+  }
+
+  sensors.requestTemperatures();
+  _conversionStart = millis();
+
+  _sensorProbe = nextProbe();
+  scheduler.start(_taskConversion, conversionTime(_sensorProbe));
+}
+
+/* Collect one scratchpad per pass so the loop is never held up for long. */
+void BrewBot::collectTemperature()
+{
+#if SIMULATE_PLANT
+  updatePlants();
+  _probeTemp[_sensorProbe] = _probePlant[_sensorProbe]->getTemp() * TEMP_ONE;
+#else
+  unsigned long start = micros();
+  int16_t raw = sensors.getTemp(probes.getAddress(_sensorProbe));
+
+  _busTime += micros() - start;
+  _busReads++;
+
+  if (raw == DEVICE_DISCONNECTED_RAW)
+  {
+    _probeTemp[_sensorProbe] = DEVICE_DISCONNECTED_C * TEMP_ONE;
+  }
+  else
+  {
+    _probeTemp[_sensorProbe] = raw >> TEMP_RAW_SHIFT;
+  }
+#endif
+
+  _pendingProbes &= ~(1 << _sensorProbe);
+  if (_pendingProbes != 0)
+  {
+    _sensorProbe = nextProbe();
+    scheduler.start(_taskConversion, conversionTime(_sensorProbe));
+  }
+}
+
+/* Pending probe that will finish converting first. */
+unsigned int BrewBot::nextProbe(void)
+{
+  unsigned int next = NUM_PROBES;
+
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    if ((_pendingProbes & (1 << i)) &&
+        (next == NUM_PROBES ||
+         probes.getResolution(i) < probes.getResolution(next)))
     {
-      temp -= 0.5;
+      next = i;
     }
+  }
+
+  return next;
+}
+
+/* Coarse readings far from target, fine ones close to it. */
+uint8_t BrewBot::selectResolution(unsigned int probe)
+{
+  if (_probeTarget[probe] == PROBE_NO_TARGET)
+  {
+    return TEMPERATURE_PRECISION;
+  }
+
+  int error = abs(_probeTemp[probe] - _probeTarget[probe]);
+
+  if (error > RESOLUTION_FAR)
+  {
+    return 9;
+  }
+  else if (error > RESOLUTION_NEAR)
+  {
+    return 10;
+  }
+  else if (error > RESOLUTION_CLOSE)
+  {
+    return 11;
+  }
+
+  return 12;
+}
+
+/* How much longer until a probe's conversion is done. On parasite power the
+ * conversions are powered from the bus, and reading any probe would cut the
+ * others short, so then it is until the slowest pending probe's is done.
+ * Those nothing is subscribed to are at 9 bits, so can't be slower. */
+unsigned long BrewBot::conversionTime(unsigned int probe)
+{
+  uint8_t bits = probes.getResolution(probe);
+
+  if (sensors.isParasitePowerMode())
+  {
+    for (unsigned int i = 0; i < NUM_PROBES; i++)
+    {
+      if ((_pendingProbes & (1 << i)) && (probes.getResolution(i) > bits))
+      {
+        bits = probes.getResolution(i);
+      }
+    }
+  }
+
+  unsigned long wait = sensors.millisToWaitForConversion(bits);
+  unsigned long elapsed = millis() - _conversionStart;
+
+  return (elapsed < wait) ? (wait - elapsed) : 0;
+}
+
+void BrewBot::tickSensor(void *cookie)
+{
+  BrewBot *brewBot = (BrewBot *)(cookie);
+
+  brewBot->profiler.begin(PROFILE_SENSORS);
+  brewBot->requestTemperatures();
+  brewBot->profiler.end(PROFILE_SENSORS);
+}
+
+void BrewBot::tickConversion(void *cookie)
+{
+  BrewBot *brewBot = (BrewBot *)(cookie);
+
+  brewBot->profiler.begin(PROFILE_SENSORS);
+  brewBot->collectTemperature();
+  brewBot->profiler.end(PROFILE_SENSORS);
+}
+
+/* Latest reading of a probe, in 1/16C. */
+int BrewBot::getProbeTemp(unsigned int probe)
+{
+  return _probeTemp[probe];
+}
+
+/* Readings of a probe are only collected while something is subscribed to
+ * it. Readings of other probes are left as they were. */
+void BrewBot::subscribeProbe(unsigned int probe, uint8_t user)
+{
+  _probeUsers[probe] |= user;
+}
+
+void BrewBot::unsubscribeProbe(unsigned int probe, uint8_t user)
+{
+  _probeUsers[probe] &= ~user;
+}
+
+/* Bus time saved by skipped scratchpad reads, in us per minute. Each skipped
+ * read is costed at the average of the reads that were done. */
+unsigned long BrewBot::getBusSaved(void)
+{
+  unsigned long elapsed = millis() - _busStart;
+
+  if (_busReads == 0 || elapsed == 0)
+  {
+    return 0;
+  }
+
+  return (unsigned long)((double)(_busTime / _busReads) * _busSkipped *
+                         60000.00 / elapsed);
+}
+
+void BrewBot::resetBusStats(void)
+{
+  _busTime = 0;
+  _busReads = 0;
+  _busSkipped = 0;
+  _busStart = millis();
+}
+
+/* Temperature something is trying to hold a probe at, or PROBE_NO_TARGET.
+ * Sets how fine the probe's readings are. */
+void BrewBot::setProbeTarget(unsigned int probe, int target)
+{
+  _probeTarget[probe] = target;
+}
+
+#if SIMULATE_PLANT
+/* Advance the simulated vessels by however long it has been since the last
+ * call. */
+void BrewBot::updatePlants(void)
+{
+  unsigned long now = millis();
+  double seconds = (now - _lastTickPlant) / 1000.00;
+
+  plantRIMS.update(seconds);
+  plantBK.update(seconds);
+
+  _lastTickPlant = now;
+}
 #endif
 
-    /* Adjust temperature to be in the range of the PID. */
-#if 1
-    double normalised = temp / (UI_TEMP_MAX - UI_TEMP_MIN);
-#else
-    double normalised = temp / 120;
+/* Other stuff */
+BrewBot brewBot = BrewBot();
+UI ui = UI(&brewBot);
+
+/* Core setup function. */
+void setup(void)
+{
+  /* Setup the debug LED. */
+  pinMode(PIN_DEBUG_LED, OUTPUT);
+
+  /* Start serial port. */
+  Serial.begin(9600);
+  Serial.println(F("BrewBot"));
+
+  /* Setup BrewBot. */
+  brewBot.setup();
+
+  /* Setup UI. */
+  ui.setup();
+
+  /* Only now start the control clock, so the time taken to set up isn't
+   * counted as a late pass. */
+  brewBot.start();
+}
+
+void loop(void)
+{
+  brewBot.profiler.begin(PROFILE_LOOP);
+  brewBot.profiler.begin(PROFILE_IDLE);
+
+#if 0
+  DeviceManager::ProcessMessages();
 #endif
 
-    output = normalised * PID_MAX;
+  /* Control comes first, and gets another look in after each piece of
+   * background work. */
+  brewBot.control();
 
-    nextTick = now + SENSOR_TIME;
+  /* Run whatever timed work is due. */
+  brewBot.profiler.begin(PROFILE_SCHEDULER);
+  bool due = brewBot.scheduler.run();
+  brewBot.profiler.end(PROFILE_SCHEDULER);
+
+  brewBot.control();
 
 #if 0
-    Serial.print("BK temp: ");
-    Serial.println(temp);
+  DeviceManager::ReportStatusUpdates();
+#endif
+
+  /* Now let the UI have a turn to run. */
+  brewBot.profiler.begin(PROFILE_UI);
+  ui.loop();
+  brewBot.profiler.end(PROFILE_UI);
+
+  brewBot.control();
+
+  /* Latch whatever the UI asked the relays to do. */
+  brewBot.flushRelays();
+
+#if DISPLAY_BACKEND != DISPLAY_TERMINAL
+  /* Send whatever events the serial port has room for. Not when the port is
+   * a terminal, binary records would garble it. */
+  brewBot.eventLog.drain(&Serial);
 #endif
+
+  handleSerial();
+
+  /* Carry on with any report asked for over serial. */
+  brewBot.report(&Serial);
+
+  /* Passes with nothing due show what a pass costs once the timed work is
+   * left out, and how many of them there are. */
+  if (!due)
+  {
+    brewBot.profiler.end(PROFILE_IDLE);
   }
 
-  return output;
+  brewBot.profiler.end(PROFILE_LOOP);
 }
 
-void setElementBK(bool value)
+/* Serial commands: 'p' dumps the loop timings, 'r' resets them, 'd'
+ * searches the bus for new probes and lists their roles, 'b' times a relay
+ * frame in whichever RELAY_MODE is built, 'f' times the probe to PID path,
+ * 'a<from> <to>' moves a probe to another role, and
+ * 'g<function> <band> <kp> <ki> <kd>' saves the PID gains for a function in
+ * a temperature band. Single letter commands act as soon as they arrive;
+ * the rest are collected a character at a time and run at the end of the
+ * line, so the loop never waits on the serial port. */
+void handleSerial(void)
 {
-  if (bk_old_value != value)
+  static char line[SERIAL_LINE_SIZE];
+  static uint8_t length = 0;
+
+  while (Serial.available() > 0)
   {
-    if (value)
+    char c = Serial.read();
+
+    if ((c == '\n') || (c == '\r'))
     {
-      Serial.println("BK on");
+      line[length] = '\0';
+      if (length > 0)
+      {
+        runSerialLine(line);
+      }
+
+      length = 0;
     }
-    else
+    else if ((length != 0) || !runSerialKey(c))
     {
-      Serial.println("BK off");
+      if (length < (SERIAL_LINE_SIZE - 1))
+      {
+        line[length++] = c;
+      }
     }
+  }
+}
 
-#if 0
-    brewBot.devElementBK.Write(value);
-#endif
+/* Commands that need nothing more than their letter. */
+bool runSerialKey(char key)
+{
+  switch (key)
+  {
+    case 'p':
+    {
+      brewBot.startReport();
+      return true;
+    }
 
-    bk_old_value = value;
+    case 'r':
+    {
+      brewBot.profiler.reset();
+      brewBot.resetBusStats();
+      brewBot.resetShortfall();
+      return true;
+    }
+
+    case 'd':
+    {
+      brewBot.probes.discover();
+      brewBot.probes.print(&Serial);
+      return true;
+    }
+
+    case 'f':
+    {
+      brewBot.printPidCycles(&Serial);
+      return true;
+    }
+
+    case 'b':
+    {
+      unsigned long us = brewBot.devRelays.timeSend(RELAY_TIME_COUNT);
+
+      Serial.print(F("relay frame (cycles): "));
+      Serial.println((us * (F_CPU / 1000000UL)) / RELAY_TIME_COUNT);
+      return true;
+    }
+
+    default:
+      break;
   }
+
+  return false;
 }
 
-void setElementBKDC(bool value)
+/* Commands with arguments, once the whole line is in. */
+void runSerialLine(char *line)
 {
-  if (bk_old_value != value)
+  char *next = line + 1;
+
+  switch (line[0])
   {
-    if (value)
+    case 'a':
     {
-      Serial.println("BK DC on");
+      unsigned int from = strtoul(next, &next, 10);
+      unsigned int to = strtoul(next, &next, 10);
+
+      if (brewBot.probes.assign(from, to))
+      {
+        brewBot.probes.print(&Serial);
+      }
+      break;
     }
-    else
+
+    case 'g':
     {
-      Serial.println("BK DC off");
+      BrewBot::gains g;
+      unsigned int function = strtoul(next, &next, 10);
+      unsigned int band = strtoul(next, &next, 10);
+
+      g.kp = strtod(next, &next);
+      g.ki = strtod(next, &next);
+      g.kd = strtod(next, &next);
+
+      if ((function < GAINS_FUNCTIONS) && (band < GAINS_BANDS))
+      {
+        brewBot.saveGains(function, band, &g);
+      }
+      break;
     }
 
+    default:
+      break;
+  }
+}
+
+
+bool rims_old_value = false;
+
+/* Called every half-cycle, so only changes are passed on. Changes aren't
+ * logged, there are too many; the demand behind them is. */
+void setElementRIMS(bool value)
+{
+  if (rims_old_value != value)
+  {
+#if 0
+    brewBot.devElementRIMS.Write(value);
+#endif
+
+#if SIMULATE_PLANT
+    brewBot.updatePlants();
+    brewBot.plantRIMS.setElement(value);
+#endif
+
+    rims_old_value = value;
+  }
+}
+
+bool bk_old_value = false;
+
+void setElementBK(bool value)
+{
+  if (bk_old_value != value)
+  {
 #if 0
-    brewBot.devElementBKDC.Write(value);
+    brewBot.devElementBK.Write(value);
+#endif
+
+#if SIMULATE_PLANT
+    brewBot.updatePlants();
+    brewBot.plantBK.setElement(value);
 #endif
 
     bk_old_value = value;
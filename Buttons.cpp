@@ -16,13 +16,147 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
 #include "Buttons.h"
 
+volatile uint8_t Buttons::_events[KEY_QUEUE_SIZE];
+volatile uint8_t Buttons::_head = 0;
+volatile uint8_t Buttons::_tail = 0;
+
+int Buttons::_candidate = KEY_NONE;
+unsigned long Buttons::_candidateTime = 0;
+int Buttons::_pressed = KEY_NONE;
+unsigned long Buttons::_pressedTime = 0;
+bool Buttons::_held = false;
+
 void Buttons::setup(void)
 {
+  /* AVcc reference, on the buttons' pin. */
+  ADMUX = (1 << REFS0) | (PIN_BUTTONS & 0x07);
+
+  /* Trigger a conversion on each timer 0 overflow. */
+  ADCSRB = (1 << ADTS2);
+
+  /* Digital input buffer isn't needed on an analog pin. */
+  DIDR0 |= (1 << PIN_BUTTONS);
+
+  /* Enable with auto trigger and interrupt, clock / 128. */
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) |
+           (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
 }
 
+/* Hand queued events to the callback. */
 void Buttons::update(void)
 {
-  _analogButtons.checkButtons();
+  while (_tail != _head)
+  {
+    uint8_t event = _events[_tail];
+    _tail = (_tail + 1) & (KEY_QUEUE_SIZE - 1);
+
+    int id = event & ~KEY_HELD_FLAG;
+    bool held = (event & KEY_HELD_FLAG) != 0;
+
+    if (_callbackPtr)
+    {
+      _callbackPtr(_ptr, id, held);
+    }
+    else
+    {
+      _callback(id, held);
+    }
+  }
+}
+
+/* Called from the ADC interrupt with each reading. A key is reported when
+ * it is released, or every KEY_DURATION while it is held down. */
+void Buttons::sample(int value)
+{
+  unsigned long now = millis();
+  int key = decode(value);
+
+  /* Wait for the reading to settle. */
+  if (key != _candidate)
+  {
+    _candidate = key;
+    _candidateTime = now;
+    return;
+  }
+
+  if (key != _pressed)
+  {
+    if ((now - _candidateTime) < KEY_DEBOUNCE)
+    {
+      return;
+    }
+
+    /* A short press counts once it is let go. */
+    if ((_pressed != KEY_NONE) && !_held)
+    {
+      push(_pressed);
+    }
+
+    _pressed = key;
+    _pressedTime = now;
+    _held = false;
+  }
+  else if ((_pressed != KEY_NONE) &&
+           ((now - _pressedTime) >= (KEY_DURATION * 1000UL)))
+  {
+    push(_pressed | KEY_HELD_FLAG);
+
+    _pressedTime = now;
+    _held = true;
+  }
+}
+
+int Buttons::decode(int value)
+{
+  if ((value >= KEY_RIGHT_LOW) && (value <= KEY_RIGHT_HIGH))
+  {
+    return KEY_RIGHT;
+  }
+  else if ((value >= KEY_UP_LOW) && (value <= KEY_UP_HIGH))
+  {
+    return KEY_UP;
+  }
+  else if ((value >= KEY_DOWN_LOW) && (value <= KEY_DOWN_HIGH))
+  {
+    return KEY_DOWN;
+  }
+  else if ((value >= KEY_LEFT_LOW) && (value <= KEY_LEFT_HIGH))
+  {
+    return KEY_LEFT;
+  }
+  else if ((value >= KEY_SELECT_LOW) && (value <= KEY_SELECT_HIGH))
+  {
+    return KEY_SELECT;
+  }
+
+  return KEY_NONE;
+}
+
+/* Single producer (the interrupt), single consumer (update()). Events are
+ * dropped if the queue is full. */
+void Buttons::push(uint8_t event)
+{
+  uint8_t next = (_head + 1) & (KEY_QUEUE_SIZE - 1);
+
+  if (next != _tail)
+  {
+    _events[_head] = event;
+    _head = next;
+  }
+}
+
+ISR(ADC_vect)
+{
+  Buttons::sample(ADC);
 }
@@ -19,7 +19,12 @@
 #ifndef BUTTONS_H
 #define BUTTONS_H
 
-#include <AnalogButtons.h>
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
 #include "pins.h"
 
 #define NUM_KEYS    5
@@ -32,8 +37,12 @@
 #define KEY_NONE    (-1)
 
 #define KEY_BUFFER    20
-#define KEY_DEBOUNCE  30
-#define KEY_DURATION   1
+#define KEY_DEBOUNCE  30  // ms
+#define KEY_DURATION   1  // s before a key counts as held, and between repeats
+
+/* Events waiting for update(). Must be a power of two. */
+#define KEY_QUEUE_SIZE  8
+#define KEY_HELD_FLAG   0x80
 
 #define KEY_RIGHT_LOW       0
 #define KEY_RIGHT_HIGH      2
@@ -49,51 +58,47 @@
 #define KEY_NONE_LOW     1000
 #define KEY_NONE_HIGH    1018
 
+/* Buttons on a resistor ladder. The ADC free-runs off the timer 0
+ * overflow (~1kHz) and its interrupt decodes, debounces and detects held
+ * keys, queueing events for update() to hand to the callback. */
 class Buttons
 {
   public:
     Buttons(void (*callback)(int, bool))
-    : _analogButtons(AnalogButtons(PIN_BUTTONS, KEY_DEBOUNCE, callback)),
-      _rightButton(Button(KEY_RIGHT, KEY_RIGHT_LOW, KEY_RIGHT_HIGH, KEY_DURATION)),
-      _upButton(Button(KEY_UP, KEY_UP_LOW, KEY_UP_HIGH, KEY_DURATION)),
-      _downButton(Button(KEY_DOWN, KEY_DOWN_LOW, KEY_DOWN_HIGH, KEY_DURATION)),
-      _leftButton(Button(KEY_LEFT, KEY_LEFT_LOW, KEY_LEFT_HIGH, KEY_DURATION)),
-      _selectButton(Button(KEY_SELECT, KEY_SELECT_LOW, KEY_SELECT_HIGH, KEY_DURATION))
+    : _callback(callback), _callbackPtr(NULL), _ptr(NULL)
     {
-      _analogButtons.addButton(_rightButton);
-      _analogButtons.addButton(_upButton);
-      _analogButtons.addButton(_downButton);
-      _analogButtons.addButton(_leftButton);
-      _analogButtons.addButton(_selectButton);
     };
 
     Buttons(void (*callback)(void*, int, bool), void *ptr)
-    : _analogButtons(AnalogButtons(PIN_BUTTONS, KEY_DEBOUNCE, callback, ptr)),
-      _rightButton(Button(KEY_RIGHT, KEY_RIGHT_LOW, KEY_RIGHT_HIGH, KEY_DURATION)),
-      _upButton(Button(KEY_UP, KEY_UP_LOW, KEY_UP_HIGH, KEY_DURATION)),
-      _downButton(Button(KEY_DOWN, KEY_DOWN_LOW, KEY_DOWN_HIGH, KEY_DURATION)),
-      _leftButton(Button(KEY_LEFT, KEY_LEFT_LOW, KEY_LEFT_HIGH, KEY_DURATION)),
-      _selectButton(Button(KEY_SELECT, KEY_SELECT_LOW, KEY_SELECT_HIGH, KEY_DURATION))
+    : _callback(NULL), _callbackPtr(callback), _ptr(ptr)
     {
-      _analogButtons.addButton(_rightButton);
-      _analogButtons.addButton(_upButton);
-      _analogButtons.addButton(_downButton);
-      _analogButtons.addButton(_leftButton);
-      _analogButtons.addButton(_selectButton);
     };
 
 
     void setup(void);
     void update(void);
 
+    static void sample(int value);
+
   private:
-    AnalogButtons _analogButtons;
-    Button _rightButton;
-    Button _upButton;
-    Button _downButton;
-    Button _leftButton;
-    Button _selectButton;
+    static int decode(int value);
+    static void push(uint8_t event);
+
+    void (*_callback)(int, bool);
+    void (*_callbackPtr)(void*, int, bool);
+    void *_ptr;
+
+    /* Shared with the ADC interrupt. */
+    static volatile uint8_t _events[KEY_QUEUE_SIZE];
+    static volatile uint8_t _head;
+    static volatile uint8_t _tail;
+
+    /* Only touched by the ADC interrupt. */
+    static int _candidate;
+    static unsigned long _candidateTime;
+    static int _pressed;
+    static unsigned long _pressedTime;
+    static bool _held;
 };
 
 #endif
-
@@ -22,8 +22,8 @@
   #include "WProgram.h"
 #endif
 
-#include <LiquidCrystal.h>
 #include "Display.h"
+#include "Format.h"
 
 #define TARGET_TEMP_X     9
 #define TARGET_TEMP_Y     1
@@ -33,39 +33,104 @@
 #define TIME_Y            1
 #define ELEMENT_STATUS_X  7
 #define ELEMENT_STATUS_Y  1
-
-#define TEMP_SIZE 7
-#define TIME_SIZE 4
-
-Display::Display()
-: _lcd(LiquidCrystal(PIN_LCD_RS, PIN_LCD_ENABLE, PIN_LCD_D0, PIN_LCD_D1, PIN_LCD_D2, PIN_LCD_D3))
+#define RAMP_X            5
+#define RAMP_Y            1
+#define STATUS_X          8
+#define STATUS_SIZE       8
+#define GAIN_X            2
+#define GAIN_SIZE         9 // "-6.63e-02"
+#define PROMPT_X          11
+
+#define TEMP_SIZE FORMAT_TEMP_SIZE
+#define TIME_SIZE FORMAT_TIME_SIZE
+
+Display::Display(DisplayBackend *backend)
+: _backend(backend)
 {
+  memset(_frame, ' ', sizeof(_frame));
+  memset(_shadow, ' ', sizeof(_shadow));
 };
 
 void Display::setup(void)
 {
-  /* Start LCD screen. */
-  _lcd.begin(16, 2);
+  /* Start LCD screen. This also clears it, matching _shadow. */
+  _backend->begin(DISPLAY_COLS, DISPLAY_ROWS);
+}
+
+/* Send the cells that have changed since the last flush, one backend write
+ * per run of changed cells, up to DISPLAY_FLUSH_MAX characters. */
+void Display::flush()
+{
+  int budget = DISPLAY_FLUSH_MAX;
+
+  for (int y = 0; y < DISPLAY_ROWS; y++)
+  {
+    int x = 0;
+
+    while ((x < DISPLAY_COLS) && (budget > 0))
+    {
+      /* Skip cells that are already right. */
+      if (_frame[y][x] == _shadow[y][x])
+      {
+        x++;
+        continue;
+      }
+
+      /* Find the end of the run, or as much of it as there is budget for. */
+      int start = x;
+      while ((x < DISPLAY_COLS) && (_frame[y][x] != _shadow[y][x]) &&
+             (budget > 0))
+      {
+        _shadow[y][x] = _frame[y][x];
+        x++;
+        budget--;
+      }
+
+      _backend->write(start, y, &_frame[y][start], x - start);
+    }
+  }
+}
+
+void Display::print(int x, int y, const char *str)
+{
+  while ((*str != '\0') && (x < DISPLAY_COLS))
+  {
+    _frame[y][x++] = *str++;
+  }
+}
+
+void Display::print(int x, int y, const char *buf, int length)
+{
+  for (int i = 0; (i < length) && (x < DISPLAY_COLS); i++)
+  {
+    _frame[y][x++] = buf[i];
+  }
+}
+
+void Display::print(int x, int y, char c)
+{
+  if (x < DISPLAY_COLS)
+  {
+    _frame[y][x] = c;
+  }
 }
 
 void Display::printStartupMessage()
 {
-  _lcd.setCursor(0, 0);
-  _lcd.print("BrewBot  v1.0");
+  print(0, 0, "BrewBot  v1.0");
 }
 
 void Display::clear(int x, int y, int length)
 {
-  _lcd.setCursor(x, y);
   for (int i = 0; i < length; i++)
   {
-      _lcd.print(" ");
+    print(x + i, y, ' ');
   }
 }
 
 void Display::clear()
 {
-  _lcd.clear();
+  memset(_frame, ' ', sizeof(_frame));
 }
 
 /* Menu functions. */
@@ -81,8 +146,7 @@ void Display::clearMenuItem()
 
 void Display::printMenuItem(int x, int y, char *item)
 {
-  _lcd.setCursor(x, y);
-  _lcd.print(item);
+  print(x, y, item);
 }
 
 void Display::printMenu(char *items[], int pos)
@@ -93,6 +157,43 @@ void Display::printMenu(char *items[], int pos)
   printMenuItem(0, 1, items[pos + 1]);
 }
 
+/* Running functions are summed up beside the menu, one per row. */
+void Display::clearStatus(int y)
+{
+  clear(STATUS_X, y, STATUS_SIZE);
+}
+
+/* Display a function's initial and step, then "R" and the time ramping if
+ * it is out of band, or else the time left, or "DONE" once it is done. */
+void Display::printStatus(int y, char name, unsigned int step, bool ramp,
+                          unsigned long time, bool done)
+{
+  char buf[STATUS_SIZE];
+
+  memset(buf, ' ', sizeof(buf));
+  buf[0] = name;
+
+  if (step != 0)
+  {
+    buf[1] = '0' + step;
+  }
+
+  if (done)
+  {
+    memcpy(&buf[STATUS_SIZE - TIME_SIZE], "DONE", TIME_SIZE);
+  }
+  else
+  {
+    if (ramp)
+    {
+      buf[STATUS_SIZE - TIME_SIZE - 1] = 'R';
+    }
+
+    formatTime(&buf[STATUS_SIZE - TIME_SIZE], time);
+  }
+
+  print(STATUS_X, y, buf, STATUS_SIZE);
+}
 
 /* Mash functions. */
 void Display::clearTemp(int x, int y)
@@ -135,13 +236,22 @@ void Display::clearElementStatus()
   clearElementStatus(ELEMENT_STATUS_X, ELEMENT_STATUS_Y);
 }
 
-void Display::printFunction(char *name, double targetTemp, double probeTemp,
+void Display::clearRamp(int x, int y)
+{
+  clear(x, y, 1);
+}
+
+void Display::clearRamp()
+{
+  clearRamp(RAMP_X, RAMP_Y);
+}
+
+void Display::printFunction(const char *name, int targetTemp, int probeTemp,
                             unsigned long time, bool elementStatus)
 {
   clear();
 
-  _lcd.setCursor(0, 0);
-  _lcd.print(name);
+  print(0, 0, name);
 
   printTargetTemp(targetTemp);
   printProbeTemp(probeTemp);
@@ -158,11 +268,27 @@ void Display::printFunction(char *name, double targetTemp, double probeTemp,
   }
 }
 
+/* Show tuned gains and ask whether to save them: SELECT saves, LEFT
+ * doesn't. */
+void Display::printGains(double kp, double ki)
+{
+  char buf[GAIN_SIZE + 1];
+
+  clear();
+
+  print(0, 0, 'P');
+  print(GAIN_X, 0, dtostre(kp, buf, 2, 0));
+  print(PROMPT_X, 0, "SAVE?");
+
+  print(0, 1, 'I');
+  print(GAIN_X, 1, dtostre(ki, buf, 2, 0));
+  print(PROMPT_X, 1, "S/L");
+}
+
 /* Display ":" if needed. */
 void Display::printIndicator(int x, int y)
 {
-  _lcd.setCursor(x, y);
-  _lcd.print(":");
+  print(x, y, ':');
 }
 
 /* Display ":" if needed. */
@@ -173,27 +299,10 @@ void Display::printIndicator()
 
 void Display::printTime(unsigned long time, int x, int y)
 {
-  unsigned long hours;
-  unsigned long mins;
-
-  /* Display the hours left. */
-  hours = time / 60;
-
-  _lcd.setCursor(x, y);
-  _lcd.print(hours);
-
-  /* Display indicator. */
-  printIndicator(x + 1, y);
+  char buf[TIME_SIZE];
 
-  /* Display the minutes left. */
-  mins = time % 60;
-
-  _lcd.setCursor(x + 2, y);
-  if (mins < 10)
-  {
-    _lcd.print(0);
-  }
-  _lcd.print(mins);
+  formatTime(buf, time);
+  print(x, y, buf, TIME_SIZE);
 }
 
 void Display::printTime(unsigned long time)
@@ -201,46 +310,23 @@ void Display::printTime(unsigned long time)
   printTime(time, TIME_X, TIME_Y);
 }
 
-/* Display a temperature. */
-void Display::printTemp(double temp, int x, int y)
+/* Display a temperature, given in 1/16C, to two decimal places. */
+void Display::printTemp(int temp, int x, int y)
 {
-  /* Clear the old value. */
-  clear(x, y, TEMP_SIZE);
-
-  /* Check for a negative temperature. */
-  if (temp < 0)
-  {
-    temp -= (2 * temp);
-    _lcd.setCursor(x, y);
-    _lcd.print("-");
-  }
+  char buf[TEMP_SIZE];
 
-  /* Right align cursor. */
-  if (temp >= 100)
-  {
-    _lcd.setCursor(x + 1, y);
-  }
-  else if (temp >= 10)
-  {
-    _lcd.setCursor(x + 2, y);
-  }
-  else
-  {
-    _lcd.setCursor(x + 3, y);
-  }
-
-  /* Print the temperature. */
-  _lcd.print(temp);
+  formatTemp(buf, temp);
+  print(x, y, buf, TEMP_SIZE);
 }
 
 /* Display the target temperature. */
-void Display::printTargetTemp(double temp)
+void Display::printTargetTemp(int temp)
 {
   printTemp(temp, TARGET_TEMP_X, TARGET_TEMP_Y);
 }
 
 /* Display a probe temperature. */
-void Display::printProbeTemp(double temp)
+void Display::printProbeTemp(int temp)
 {
   printTemp(temp, PROBE_TEMP_X, PROBE_TEMP_Y);
 }
@@ -248,8 +334,7 @@ void Display::printProbeTemp(double temp)
 /* Display the element status. */
 void Display::printElementStatus(int x, int y)
 {
-  _lcd.setCursor(x, y);
-  _lcd.print("*");
+  print(x, y, '*');
 }
 
 /* Display the element status. */
@@ -258,4 +343,14 @@ void Display::printElementStatus()
   printElementStatus(ELEMENT_STATUS_X, ELEMENT_STATUS_Y);
 }
 
+/* Mark the time as the ramp up to a step rather than the step itself. */
+void Display::printRamp(int x, int y)
+{
+  print(x, y, 'R');
+}
 
+/* Mark the time as the ramp up to a step rather than the step itself. */
+void Display::printRamp()
+{
+  printRamp(RAMP_X, RAMP_Y);
+}
@@ -19,16 +19,24 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
-#include <LiquidCrystal.h>
-
+#include "constants.h"
 #include "pins.h"
+#include "DisplayBackend.h"
+
+#define DISPLAY_COLS  16
+#define DISPLAY_ROWS   2
+
+/* Most characters sent per flush(), so a full redraw can't hold up the
+ * control loop. The rest go out on the next flush(). */
+#define DISPLAY_FLUSH_MAX  8
 
 class Display
 {
   public:
-    Display();
+    Display(DisplayBackend *backend);
 
     void setup();
+    void flush();
 
     void printStartupMessage();
 
@@ -40,6 +48,9 @@ class Display
     void clearMenuItem();
     void printMenuItem(int x, int y, char *item);
     void printMenu(char *items[], int pos);
+    void clearStatus(int y);
+    void printStatus(int y, char name, unsigned int step, bool ramp,
+                     unsigned long time, bool done);
 
     /* Mash functions. */
     void clearTemp(int x, int y);
@@ -50,22 +61,36 @@ class Display
     void clearIndicator();
     void clearElementStatus(int x, int y);
     void clearElementStatus();
+    void clearRamp(int x, int y);
+    void clearRamp();
 
-    void printTemp(double temp, int x, int y);
-    void printTargetTemp(double temp);
-    void printProbeTemp(double temp);
+    void printTemp(int temp, int x, int y);
+    void printTargetTemp(int temp);
+    void printProbeTemp(int temp);
     void printTime(unsigned long time, int x, int y);
     void printTime(unsigned long time);
     void printIndicator(int x, int y);
     void printIndicator(void);
     void printElementStatus(int x, int y);
     void printElementStatus();
+    void printRamp(int x, int y);
+    void printRamp();
 
-    void printFunction(char *name, double targetTemp, double probeTemp,
+    void printFunction(const char *name, int targetTemp, int probeTemp,
                        unsigned long time, bool elementStatus);
+    void printGains(double kp, double ki);
 
   private:
-    LiquidCrystal _lcd;
+    void print(int x, int y, const char *str);
+    void print(int x, int y, const char *buf, int length);
+    void print(int x, int y, char c);
+
+    DisplayBackend *_backend;
+
+    /* What should be on the screen, and what the LCD is showing. Drawing
+     * only touches _frame; flush() sends the difference. */
+    char _frame[DISPLAY_ROWS][DISPLAY_COLS];
+    char _shadow[DISPLAY_ROWS][DISPLAY_COLS];
 };
 
 #endif
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include "EventLog.h"
+
+EventLog::EventLog()
+: _head(0), _tail(0), _dropped(0), _totalDropped(0)
+{
+}
+
+void EventLog::log(uint8_t id, int value)
+{
+  uint8_t next = (_head + 1) & (EVENT_LOG_SIZE - 1);
+
+  if (next == _tail)
+  {
+    _dropped++;
+    _totalDropped++;
+    return;
+  }
+
+  record *r = &_records[_head];
+  r->time = millis();
+  r->id = id;
+  r->value = value;
+
+  _head = next;
+}
+
+/* Send as many whole records as the serial TX buffer has room for. */
+void EventLog::drain(HardwareSerial *out)
+{
+  /* Report losses once there is room to log them. */
+  if (_dropped && (((_head + 1) & (EVENT_LOG_SIZE - 1)) != _tail))
+  {
+    unsigned int dropped = _dropped;
+    _dropped = 0;
+    log(EVENT_DROPPED, dropped);
+  }
+
+  while ((_tail != _head) &&
+         (out->availableForWrite() >= EVENT_LOG_RECORD_SIZE))
+  {
+    record *r = &_records[_tail];
+    uint8_t buf[EVENT_LOG_RECORD_SIZE];
+
+    buf[0] = EVENT_LOG_SYNC;
+    buf[1] = r->time;
+    buf[2] = r->time >> 8;
+    buf[3] = r->time >> 16;
+    buf[4] = r->time >> 24;
+    buf[5] = r->id;
+    buf[6] = r->value;
+    buf[7] = r->value >> 8;
+
+    out->write(buf, EVENT_LOG_RECORD_SIZE);
+
+    _tail = (_tail + 1) & (EVENT_LOG_SIZE - 1);
+  }
+}
+
+/* Records lost since start-up. */
+unsigned int EventLog::getDropped(void)
+{
+  return _totalDropped;
+}
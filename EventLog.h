@@ -0,0 +1,67 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+/* Number of records held. Must be a power of two. */
+#define EVENT_LOG_SIZE  32
+
+/* Records go out as a sync byte, then little endian millis(), id, value. */
+#define EVENT_LOG_SYNC         0xA5
+#define EVENT_LOG_RECORD_SIZE  8
+
+/* Reported with the number of records lost since the last one. */
+#define EVENT_DROPPED  0xFF
+
+/* Fixed-size log of compact binary records that is drained to the serial
+ * port only as fast as it can take them. Logging never blocks; if the log
+ * is full the record is counted as dropped instead. */
+class EventLog
+{
+  public:
+    EventLog();
+
+    void log(uint8_t id, int value);
+    void drain(HardwareSerial *out);
+
+    unsigned int getDropped(void);
+
+  private:
+    struct record
+    {
+      unsigned long time;
+      uint8_t id;
+      int value;
+    };
+
+    record _records[EVENT_LOG_SIZE];
+    uint8_t _head;
+    uint8_t _tail;
+
+    unsigned int _dropped;
+    unsigned int _totalDropped;
+};
+
+#endif
@@ -0,0 +1,68 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "constants.h"
+#include "Format.h"
+
+/* Render a 1/16C temperature to two decimal places, right aligned, with
+ * the sign (or a space) in the first column. */
+void formatTemp(char *buf, int temp)
+{
+  unsigned int value = (temp < 0) ? -temp : temp;
+  unsigned int whole = value >> TEMP_SHIFT;
+  unsigned int frac;
+  char *p = buf + FORMAT_TEMP_SIZE;
+
+  /* Hundredths, rounding the sixteenths. */
+  frac = (((value & (TEMP_ONE - 1)) * 100) + (TEMP_ONE / 2)) >> TEMP_SHIFT;
+
+  *--p = '0' + (frac % 10);
+  *--p = '0' + (frac / 10);
+  *--p = '.';
+
+  do
+  {
+    *--p = '0' + (whole % 10);
+    whole /= 10;
+  } while ((whole != 0) && (p > buf + 1));
+
+  while (p > buf + 1)
+  {
+    *--p = ' ';
+  }
+
+  buf[0] = (temp < 0) ? '-' : ' ';
+}
+
+/* Render a time in minutes as H:MM. */
+void formatTime(char *buf, unsigned long time)
+{
+  unsigned int hours = time / 60;
+  unsigned int mins = time % 60;
+
+  /* UI_TIME_MAX keeps this to one digit. */
+  if (hours > 9)
+  {
+    hours = 9;
+  }
+
+  buf[0] = '0' + hours;
+  buf[1] = ':';
+  buf[2] = '0' + (mins / 10);
+  buf[3] = '0' + (mins % 10);
+}
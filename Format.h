@@ -0,0 +1,33 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+/* Sign, up to three digits, point and two decimals: "- 65.50". */
+#define FORMAT_TEMP_SIZE  7
+
+/* H:MM */
+#define FORMAT_TIME_SIZE  4
+
+/* Integer-only, fixed-width rendering of the values shown on the LCD. The
+ * buffers are filled in one pass and are not NUL terminated. */
+void formatTemp(char *buf, int temp);
+void formatTime(char *buf, unsigned long time);
+
+#endif
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include <Wire.h>
+
+#include "I2CBackend.h"
+
+I2CBackend::I2CBackend(uint8_t address)
+: _address(address)
+{
+}
+
+void I2CBackend::begin(uint8_t, uint8_t rows)
+{
+  Wire.begin();
+
+  /* Wait for the LCD to power up. */
+  delay(50);
+
+  /* Force 4-bit mode from whatever state it is in. */
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    Wire.beginTransmission(_address);
+    queueNibble(0x30);
+    Wire.endTransmission();
+    delay(5);
+  }
+
+  Wire.beginTransmission(_address);
+  queueNibble(0x20);
+  Wire.endTransmission();
+
+  /* 4-bit, two lines, display on, clear, left to right. */
+  command((rows > 1) ? 0x28 : 0x20);
+  command(0x0C);
+  command(0x01);
+  delay(2);
+  command(0x06);
+}
+
+/* Set the cursor, then send the run in as few transmissions as fit. */
+void I2CBackend::write(uint8_t x, uint8_t y, const char *buf, uint8_t length)
+{
+  command(0x80 | (x + ((y == 0) ? 0x00 : 0x40)));
+
+  while (length > 0)
+  {
+    uint8_t batch = (length > I2C_LCD_BATCH) ? I2C_LCD_BATCH : length;
+
+    Wire.beginTransmission(_address);
+    for (uint8_t i = 0; i < batch; i++)
+    {
+      queue(buf[i], I2C_LCD_RS);
+    }
+    Wire.endTransmission();
+
+    buf += batch;
+    length -= batch;
+  }
+}
+
+void I2CBackend::command(uint8_t value)
+{
+  Wire.beginTransmission(_address);
+  queue(value, 0);
+  Wire.endTransmission();
+}
+
+/* Add one LCD byte to the open transmission. At 100kHz each bus byte takes
+ * longer than the LCD needs to execute, so no extra delays are needed. */
+void I2CBackend::queue(uint8_t value, uint8_t mode)
+{
+  queueNibble((value & 0xF0) | mode);
+  queueNibble(((value << 4) & 0xF0) | mode);
+}
+
+void I2CBackend::queueNibble(uint8_t nibble)
+{
+  Wire.write(nibble | I2C_LCD_BACKLIGHT | I2C_LCD_ENABLE);
+  Wire.write(nibble | I2C_LCD_BACKLIGHT);
+}
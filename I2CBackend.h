@@ -0,0 +1,51 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef I2C_BACKEND_H
+#define I2C_BACKEND_H
+
+#include "DisplayBackend.h"
+
+/* Most I2C backpacks wire the PCF8574 like this. */
+#define I2C_LCD_RS         0x01
+#define I2C_LCD_ENABLE     0x04
+#define I2C_LCD_BACKLIGHT  0x08
+
+/* Wire's buffer is 32 bytes and each LCD byte costs 4 bus bytes (two
+ * nibbles, each strobed high then low). */
+#define I2C_LCD_BATCH  (32 / 4)
+
+/* HD44780 behind a PCF8574 I2C backpack. Every nibble is a bus write, so
+ * a whole run of cells is packed into as few transmissions as possible. */
+class I2CBackend : public DisplayBackend
+{
+  public:
+    I2CBackend(uint8_t address);
+
+    void begin(uint8_t cols, uint8_t rows);
+    void write(uint8_t x, uint8_t y, const char *buf, uint8_t length);
+
+  private:
+    void command(uint8_t value);
+    void queue(uint8_t value, uint8_t mode);
+    void queueNibble(uint8_t nibble);
+
+    uint8_t _address;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Modulator.h"
+
+/* window: half-cycles per window (window mode)
+ * steps: on-times a window can be split into (window mode) */
+Modulator::Modulator(unsigned char mode, unsigned int window,
+                     unsigned int steps)
+: _mode(mode), _window(window), _steps(steps), _demand(0), _acc(0),
+  _count(0)
+{
+}
+
+/* Demand between 0 (off) and 1 (full power). */
+void Modulator::setDemand(double demand)
+{
+  if (demand < 0.00)
+  {
+    demand = 0.00;
+  }
+  else if (demand > 1.00)
+  {
+    demand = 1.00;
+  }
+
+  _demand = (unsigned int)((demand * MODULATOR_SCALE) + 0.50);
+}
+
+/* Demand in 1/MODULATOR_SCALE. */
+unsigned int Modulator::getDemand(void)
+{
+  return _demand;
+}
+
+/* Whether the element is on for the next half-cycle. */
+bool Modulator::step(void)
+{
+  switch (_mode)
+  {
+    case MODULATOR_WINDOW:
+    {
+      /* Round the demand to a whole number of steps. */
+      unsigned long steps =
+        (((unsigned long)(_demand) * _steps) + (MODULATOR_SCALE / 2)) /
+        MODULATOR_SCALE;
+      unsigned long on = (steps * _window) / _steps;
+
+      bool value = (_count < on);
+
+      if (++_count >= _window)
+      {
+        _count = 0;
+      }
+
+      return value;
+    }
+
+    case MODULATOR_BURST:
+    default:
+    {
+      _acc += _demand;
+      if (_acc >= MODULATOR_SCALE)
+      {
+        _acc -= MODULATOR_SCALE;
+        return true;
+      }
+
+      return false;
+    }
+  }
+}
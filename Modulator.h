@@ -0,0 +1,54 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MODULATOR_H
+#define MODULATOR_H
+
+/* Modulation modes. */
+#define MODULATOR_BURST   0 // Spread over single half-cycles
+#define MODULATOR_WINDOW  1 // One on-time per window
+
+/* Fixed point scale of the demand. */
+#define MODULATOR_SCALE  1024
+
+/* Turns a demand into an element on/off pattern, one AC half-cycle at a
+ * time. In burst mode the demand is accumulated Bresenham style, so on
+ * half-cycles are spread as evenly as possible and the resolution is a
+ * single half-cycle. Window mode switches on once per window, in a set
+ * number of steps, the way the old duty cycle devices did. */
+class Modulator
+{
+  public:
+    Modulator(unsigned char mode, unsigned int window, unsigned int steps);
+
+    void setDemand(double demand);
+    unsigned int getDemand(void);
+
+    bool step(void);
+
+  private:
+    unsigned char _mode;
+    unsigned int _window;
+    unsigned int _steps;
+
+    unsigned int _demand;
+    unsigned int _acc;
+    unsigned int _count;
+};
+
+#endif
@@ -0,0 +1,45 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include <LiquidCrystal.h>
+
+#include "ParallelBackend.h"
+
+ParallelBackend::ParallelBackend(uint8_t rs, uint8_t enable,
+                                 uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3)
+: _lcd(rs, enable, d0, d1, d2, d3)
+{
+}
+
+void ParallelBackend::begin(uint8_t cols, uint8_t rows)
+{
+  _lcd.begin(cols, rows);
+}
+
+void ParallelBackend::write(uint8_t x, uint8_t y, const char *buf,
+                            uint8_t length)
+{
+  _lcd.setCursor(x, y);
+  _lcd.write((const uint8_t *)buf, length);
+}
@@ -0,0 +1,40 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PARALLEL_BACKEND_H
+#define PARALLEL_BACKEND_H
+
+#include <LiquidCrystal.h>
+
+#include "DisplayBackend.h"
+
+/* HD44780 on the 4-bit parallel PIN_LCD_* pins. */
+class ParallelBackend : public DisplayBackend
+{
+  public:
+    ParallelBackend(uint8_t rs, uint8_t enable,
+                    uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3);
+
+    void begin(uint8_t cols, uint8_t rows);
+    void write(uint8_t x, uint8_t y, const char *buf, uint8_t length);
+
+  private:
+    LiquidCrystal _lcd;
+};
+
+#endif
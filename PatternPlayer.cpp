@@ -0,0 +1,115 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include <BooleanDevice.h>
+
+#include "Scheduler.h"
+#include "PatternPlayer.h"
+
+PatternPlayer::PatternPlayer(Scheduler *scheduler, BooleanDevice *device)
+: _scheduler(scheduler), _device(device), _task(SCHEDULER_NO_TASK),
+  _head(0), _count(0), _playing(false)
+{
+}
+
+/* Returns false if the scheduler had no room for the player's task. */
+bool PatternPlayer::setup(void)
+{
+  _task = _scheduler->addTask(tick, this, 0);
+
+  return (_task != SCHEDULER_NO_TASK);
+}
+
+/* Drop whatever is playing and hold the device at value. */
+void PatternPlayer::set(bool value)
+{
+  _scheduler->stop(_task);
+  _head = 0;
+  _count = 0;
+  _playing = false;
+
+  _device->Write(value);
+}
+
+/* Add a step holding the device at value for time ms. Returns false if the
+ * queue is full. */
+bool PatternPlayer::queue(bool value, unsigned int time)
+{
+  if (_count >= PATTERN_MAX_STEPS)
+  {
+    return false;
+  }
+
+  step *s = &_steps[(_head + _count) % PATTERN_MAX_STEPS];
+  s->value = value;
+  s->time = time;
+  _count++;
+
+  if (!_playing)
+  {
+    next();
+  }
+
+  return true;
+}
+
+/* Queue count on/off pulses. */
+void PatternPlayer::pulse(unsigned int on, unsigned int off, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    queue(true, on);
+    queue(false, off);
+  }
+}
+
+bool PatternPlayer::isPlaying(void)
+{
+  return _playing;
+}
+
+/* Start the next step. Once the queue runs dry the device is switched off. */
+void PatternPlayer::next(void)
+{
+  if (_count == 0)
+  {
+    _device->Write(false);
+    _playing = false;
+
+    return;
+  }
+
+  step *s = &_steps[_head];
+  _head = (_head + 1) % PATTERN_MAX_STEPS;
+  _count--;
+
+  _device->Write(s->value);
+  _scheduler->start(_task, s->time);
+  _playing = true;
+}
+
+void PatternPlayer::tick(void *cookie)
+{
+  ((PatternPlayer *)(cookie))->next();
+}
@@ -0,0 +1,65 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PATTERN_PLAYER_H
+#define PATTERN_PLAYER_H
+
+#include <BooleanDevice.h>
+
+#include "Scheduler.h"
+
+#define PATTERN_MAX_STEPS  8
+
+/* Plays queued on/off sequences on a BooleanDevice (beeper, indicator)
+ * from the scheduler, so feedback never stalls the loop. */
+class PatternPlayer
+{
+  public:
+    PatternPlayer(Scheduler *scheduler, BooleanDevice *device);
+
+    bool setup(void);
+
+    void set(bool value);
+    bool queue(bool value, unsigned int time);
+    void pulse(unsigned int on, unsigned int off, unsigned int count);
+
+    bool isPlaying(void);
+
+  private:
+    static void tick(void *cookie);
+
+    void next(void);
+
+    struct step
+    {
+      bool value;
+      unsigned int time;
+    };
+
+    Scheduler *_scheduler;
+    BooleanDevice *_device;
+    int _task;
+
+    step _steps[PATTERN_MAX_STEPS];
+    unsigned int _head;
+    unsigned int _count;
+
+    bool _playing;
+};
+
+#endif
@@ -0,0 +1,199 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Pid.h"
+
+/* kp: demand per unit of error
+ * ki: demand per unit of error per second
+ * kd: demand per unit of change per second
+ * sampleTime: seconds between calls to compute() */
+Pid::Pid(double kp, double ki, double kd, double sampleTime)
+: _kp(kp), _ki(ki), _kd(kd), _sampleTime(sampleTime), _setpoint(0.00),
+  _target(0.00), _ramp(0.00), _riseStart(0.00), _riseSamples(0),
+  _riseRate(0.00), _integral(0.00), _lastInput(0.00), _output(0.00),
+  _enabled(false), _first(true)
+{
+}
+
+void Pid::setTunings(double kp, double ki, double kd)
+{
+  _kp = kp;
+  _ki = ki;
+  _kd = kd;
+}
+
+/* With a ramp, a higher set point is worked up to from compute(). A lower
+ * one takes effect at once, since the element can't cool any faster. */
+void Pid::setSetpoint(double setpoint)
+{
+  _target = setpoint;
+
+  if ((_ramp <= 0.00) || (_target < _setpoint))
+  {
+    _setpoint = _target;
+  }
+}
+
+/* Set point currently being held to, part way up a ramp. */
+double Pid::getSetpoint(void)
+{
+  return _setpoint;
+}
+
+/* Set point being ramped towards. */
+double Pid::getTarget(void)
+{
+  return _target;
+}
+
+/* rate: most the set point rises per second, or 0 to jump straight to it */
+void Pid::setRamp(double rate)
+{
+  _ramp = rate;
+
+  if (_ramp <= 0.00)
+  {
+    _setpoint = _target;
+  }
+}
+
+double Pid::getRamp(void)
+{
+  return _ramp;
+}
+
+/* Input rise per second last seen at full power, or 0 if not yet known. */
+double Pid::getRiseRate(void)
+{
+  return _riseRate;
+}
+
+/* Starting afresh each time it is turned on. */
+void Pid::enable(bool on)
+{
+  if (on && !_enabled)
+  {
+    _integral = 0.00;
+    _first = true;
+  }
+
+  if (!on)
+  {
+    _output = 0.00;
+  }
+
+  _enabled = on;
+}
+
+bool Pid::isEnabled(void)
+{
+  return _enabled;
+}
+
+double Pid::compute(double input)
+{
+  if (!_enabled)
+  {
+    return 0.00;
+  }
+
+  /* Ramps are only between set points. Coming on from cold, it starts at
+   * the target. */
+  if (_first)
+  {
+    _setpoint = _target;
+  }
+  else if (_setpoint < _target)
+  {
+    _setpoint += _ramp * _sampleTime;
+    if (_setpoint > _target)
+    {
+      _setpoint = _target;
+    }
+  }
+
+  double error = _setpoint - input;
+
+  double derivative = 0.00;
+  if (!_first)
+  {
+    derivative = (input - _lastInput) / _sampleTime;
+  }
+
+  double proportional = (_kp * error) - (_kd * derivative);
+  double step = _ki * error * _sampleTime;
+  double output = proportional + _integral + step;
+
+  /* Conditional integration: while the output is saturated, only integrate
+   * what would bring it back. This stops the integral winding up over a
+   * long heat-up, when the output sits at full power. */
+  if (((output < 1.00) || (step < 0.00)) && ((output > 0.00) || (step > 0.00)))
+  {
+    _integral += step;
+  }
+
+  /* Keep the integral within what the output can do. */
+  if (_integral > 1.00)
+  {
+    _integral = 1.00;
+  }
+  else if (_integral < 0.00)
+  {
+    _integral = 0.00;
+  }
+
+  _output = proportional + _integral;
+  if (_output > 1.00)
+  {
+    _output = 1.00;
+  }
+  else if (_output < 0.00)
+  {
+    _output = 0.00;
+  }
+
+  /* Time how fast the input rises for as long as the output stays at full
+   * power. Measuring over the whole run gets finer as it goes on. */
+  if (_output >= 1.00)
+  {
+    if (_riseSamples == 0)
+    {
+      _riseStart = input;
+    }
+    else if (_riseSamples >= PID_RISE_SAMPLES)
+    {
+      _riseRate = (input - _riseStart) / (_riseSamples * _sampleTime);
+    }
+
+    _riseSamples++;
+  }
+  else
+  {
+    _riseSamples = 0;
+  }
+
+  _lastInput = input;
+  _first = false;
+
+  return _output;
+}
+
+double Pid::getOutput(void)
+{
+  return _output;
+}
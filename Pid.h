@@ -0,0 +1,73 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PID_H
+#define PID_H
+
+/* Samples at full power before the rise rate is trusted. */
+#define PID_RISE_SAMPLES  10
+
+/* PID controller giving a demand between 0 (off) and 1 (full power). It
+ * runs at a fixed sample time, so compute() must be called once per sample.
+ * The derivative is taken on the measurement so set point changes don't
+ * kick the output, and the integral is only built up while the output
+ * isn't saturated. The set point can be ramped up at a limited rate rather
+ * than jumping, and the rate the input rises at under full power is
+ * measured so callers can tell how long a heat-up will take. */
+class Pid
+{
+  public:
+    Pid(double kp, double ki, double kd, double sampleTime);
+
+    void setTunings(double kp, double ki, double kd);
+    void setSetpoint(double setpoint);
+    double getSetpoint(void);
+    double getTarget(void);
+
+    void setRamp(double rate);
+    double getRamp(void);
+    double getRiseRate(void);
+
+    void enable(bool on);
+    bool isEnabled(void);
+
+    double compute(double input);
+    double getOutput(void);
+
+  private:
+    double _kp;
+    double _ki;
+    double _kd;
+    double _sampleTime;
+
+    double _setpoint;
+    double _target;
+    double _ramp;
+
+    double _riseStart;
+    unsigned long _riseSamples;
+    double _riseRate;
+    double _integral;
+    double _lastInput;
+    double _output;
+
+    bool _enabled;
+    bool _first;
+};
+
+#endif
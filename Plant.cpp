@@ -0,0 +1,91 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <math.h>
+
+#include "Plant.h"
+
+/* power: element power (W)
+ * mass: heat capacity of the vessel contents (J/C)
+ * loss: heat loss to the surroundings (W/C)
+ * boil: temperature the contents can't be heated past (C)
+ * dead: time for heat from the element to reach the probe (s) */
+Plant::Plant(double temp, double power, double mass, double loss,
+             double ambient, double boil, double dead)
+: _temp(temp), _power(power), _mass(mass), _loss(loss), _ambient(ambient),
+  _boil(boil), _dead(dead), _element(false), _slot(0), _slotTime(0.00)
+{
+  for (unsigned int i = 0; i < PLANT_DELAY_SLOTS; i++)
+  {
+    _delayed[i] = temp;
+  }
+}
+
+void Plant::setElement(bool on)
+{
+  _element = on;
+}
+
+bool Plant::getElement(void)
+{
+  return _element;
+}
+
+/* Advance the model. The step response is solved exactly rather than
+ * integrated, so large steps stay stable. */
+void Plant::update(double seconds)
+{
+  double power = _element ? _power : 0.00;
+
+  /* Temperature the vessel would settle at with the element as it is. */
+  double steady = _ambient + (power / _loss);
+  double tau = _mass / _loss;
+
+  _temp = steady + ((_temp - steady) * exp(-seconds / tau));
+
+  /* Extra energy just boils water off. */
+  if (_temp > _boil)
+  {
+    _temp = _boil;
+  }
+
+  if (_dead <= 0.00)
+  {
+    return;
+  }
+
+  /* Keep a temperature every slot's worth of time, in place of the oldest. */
+  double slot = _dead / PLANT_DELAY_SLOTS;
+
+  for (_slotTime += seconds; _slotTime >= slot; _slotTime -= slot)
+  {
+    _delayed[_slot] = _temp;
+    _slot = (_slot + 1) % PLANT_DELAY_SLOTS;
+  }
+}
+
+/* Temperature at the probe, which is the vessel's from the dead time ago. */
+double Plant::getTemp(void)
+{
+  if (_dead <= 0.00)
+  {
+    return _temp;
+  }
+
+  return _delayed[_slot];
+}
@@ -0,0 +1,59 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PLANT_H
+#define PLANT_H
+
+/* Readings held back to make the dead time. The delay is only as fine as
+ * the dead time over this. */
+#define PLANT_DELAY_SLOTS  8
+
+/* First-order thermal model of a heated vessel with dead time, used in
+ * place of the temperature probes when SIMULATE_PLANT is set, and by
+ * tools/simulate. */
+class Plant
+{
+  public:
+    Plant(double temp, double power, double mass, double loss,
+          double ambient, double boil, double dead);
+
+    void setElement(bool on);
+    bool getElement(void);
+
+    void update(double seconds);
+    double getTemp(void);
+
+  private:
+    double _temp;
+    double _power;
+    double _mass;
+    double _loss;
+    double _ambient;
+    double _boil;
+    double _dead;
+
+    bool _element;
+
+    /* Past temperatures, one every _dead / PLANT_DELAY_SLOTS seconds. The
+     * oldest is the one at _slot. */
+    double _delayed[PLANT_DELAY_SLOTS];
+    unsigned int _slot;
+    double _slotTime;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PowerArbiter.h"
+
+/* limit: most power that can be drawn at once (W) */
+PowerArbiter::PowerArbiter(double limit)
+: _limit(limit), _numLoads(0), _first(0)
+{
+}
+
+/* power: what the load draws when on (W) */
+int PowerArbiter::addLoad(double power)
+{
+  if (_numLoads >= ARBITER_MAX_LOADS)
+  {
+    return -1;
+  }
+
+  load *l = &_loads[_numLoads];
+
+  l->power = power;
+  l->owed = 0;
+  l->requested = 0;
+  l->delivered = 0;
+
+  return _numLoads++;
+}
+
+/* want: bit n set if load n wants the next half-cycle. Returns the loads
+ * to turn on the same way. */
+unsigned int PowerArbiter::step(unsigned int want)
+{
+  unsigned int on = 0;
+  double budget = _limit;
+
+  for (int i = 0; i < _numLoads; i++)
+  {
+    load *l = &_loads[i];
+
+    if (want & (1 << i))
+    {
+      l->requested++;
+
+      if (l->owed < ARBITER_BACKLOG)
+      {
+        l->owed++;
+      }
+    }
+
+    /* Halve the totals rather than overflow; the ratio stays the same. */
+    if (l->requested & 0x80000000UL)
+    {
+      l->requested >>= 1;
+      l->delivered >>= 1;
+    }
+  }
+
+  /* Grant the most owed first, skipping any that don't fit. */
+  for (;;)
+  {
+    int next = -1;
+
+    for (int n = 0; n < _numLoads; n++)
+    {
+      int i = (_first + n) % _numLoads;
+      load *l = &_loads[i];
+
+      if (!(on & (1 << i)) && (l->owed > 0) && (l->power <= budget) &&
+          ((next < 0) || (l->owed > _loads[next].owed)))
+      {
+        next = i;
+      }
+    }
+
+    if (next < 0)
+    {
+      break;
+    }
+
+    _loads[next].owed--;
+    _loads[next].delivered++;
+    budget -= _loads[next].power;
+    on |= (1 << next);
+  }
+
+  if (++_first >= _numLoads)
+  {
+    _first = 0;
+  }
+
+  return on;
+}
+
+/* Forget what a load is owed, so it stops as soon as it stops asking
+ * rather than working off its backlog. */
+void PowerArbiter::cancel(int load)
+{
+  _loads[load].owed = 0;
+}
+
+/* Percentage of the half-cycles a load asked for that it didn't get. */
+unsigned int PowerArbiter::getShortfall(int load)
+{
+  struct load *l = &_loads[load];
+
+  if (l->delivered >= l->requested)
+  {
+    return 0;
+  }
+
+  return ((l->requested - l->delivered) * 100.00) / l->requested;
+}
+
+void PowerArbiter::reset(void)
+{
+  for (int i = 0; i < _numLoads; i++)
+  {
+    _loads[i].owed = 0;
+    _loads[i].requested = 0;
+    _loads[i].delivered = 0;
+  }
+}
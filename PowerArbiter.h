@@ -0,0 +1,63 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POWER_ARBITER_H
+#define POWER_ARBITER_H
+
+#define ARBITER_MAX_LOADS  4
+
+/* Half-cycles a load can be owed before further requests are dropped. */
+#define ARBITER_BACKLOG  8
+
+/* Shares a supply that can't carry every load at once. Each half-cycle the
+ * loads that want to be on are granted, most owed first, for as long as
+ * they fit in the limit. A load that doesn't fit is owed the half-cycle and
+ * gets it as soon as there is room, so the total delivered stays as high as
+ * the limit allows. */
+class PowerArbiter
+{
+  public:
+    PowerArbiter(double limit);
+
+    int addLoad(double power);
+
+    unsigned int step(unsigned int want);
+    void cancel(int load);
+
+    unsigned int getShortfall(int load);
+    void reset(void);
+
+  private:
+    struct load
+    {
+      double power;
+      unsigned char owed;
+      unsigned long requested;
+      unsigned long delivered;
+    };
+
+    double _limit;
+
+    load _loads[ARBITER_MAX_LOADS];
+    int _numLoads;
+
+    /* Load that wins ties, which moves round each half-cycle. */
+    int _first;
+};
+
+#endif
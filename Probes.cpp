@@ -0,0 +1,273 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include <EEPROM.h>
+
+#include "constants.h"
+#include "Probes.h"
+
+/* Order free roles are filled in by a search. */
+const uint8_t bindOrder[NUM_PROBES] =
+{
+  PROBE_RIMS, PROBE_BK, PROBE_MASH, PROBE_HLT, PROBE_CHILLER
+};
+
+Probes::Probes(OneWire *oneWire, DallasTemperature *sensors)
+: _oneWire(oneWire), _sensors(sensors)
+{
+  memset(_addr, 0, sizeof(_addr));
+
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    _resolution[i] = TEMPERATURE_PRECISION;
+  }
+}
+
+void Probes::setup(void)
+{
+  load();
+
+  if (!verify())
+  {
+    discover();
+  }
+
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    if (isBound(i))
+    {
+      _sensors->setResolution(_addr[i], TEMPERATURE_PRECISION);
+    }
+  }
+}
+
+/* Search the bus, binding any probes that don't have a role yet. Roles
+ * whose probe has gone are freed first so a replacement can take them. */
+void Probes::discover(void)
+{
+  DeviceAddress addr;
+
+  verify();
+
+  _oneWire->reset_search();
+  while (_oneWire->search(addr))
+  {
+    if (_sensors->validAddress(addr) && _sensors->validFamily(addr))
+    {
+      bind(addr);
+    }
+  }
+
+  save();
+}
+
+/* Move the probe in one role to another, swapping with whatever was
+ * there. */
+bool Probes::assign(unsigned int from, unsigned int to)
+{
+  DeviceAddress addr;
+  uint8_t resolution;
+
+  if ((from >= NUM_PROBES) || (to >= NUM_PROBES))
+  {
+    return false;
+  }
+
+  memcpy(addr, _addr[to], sizeof(DeviceAddress));
+  memcpy(_addr[to], _addr[from], sizeof(DeviceAddress));
+  memcpy(_addr[from], addr, sizeof(DeviceAddress));
+
+  resolution = _resolution[to];
+  _resolution[to] = _resolution[from];
+  _resolution[from] = resolution;
+
+  save();
+
+  return true;
+}
+
+/* One line per role: its number, then its probe's address or nothing. */
+void Probes::print(Print *out)
+{
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    out->print(i);
+    out->print(':');
+
+    if (isBound(i))
+    {
+      for (unsigned int j = 0; j < sizeof(DeviceAddress); j++)
+      {
+        out->print(' ');
+        if (_addr[i][j] < 0x10)
+        {
+          out->print('0');
+        }
+        out->print(_addr[i][j], HEX);
+      }
+    }
+
+    out->println();
+  }
+}
+
+bool Probes::isBound(unsigned int probe)
+{
+  /* No valid ROM has a zero family code. */
+  return (_addr[probe][0] != 0);
+}
+
+const uint8_t *Probes::getAddress(unsigned int probe)
+{
+  return _addr[probe];
+}
+
+/* Change a probe's resolution. This changes often, so the scratchpad is
+ * written directly rather than through DallasTemperature, which also copies
+ * it to the probe's EEPROM and waits for that. The probe goes back to
+ * TEMPERATURE_PRECISION when it is powered up. Must not be called during a
+ * conversion. */
+void Probes::setResolution(unsigned int probe, uint8_t bits)
+{
+  if (bits == _resolution[probe])
+  {
+    return;
+  }
+
+  _resolution[probe] = bits;
+
+  /* The DS18S20 only has the one resolution. */
+  if (!isBound(probe) || _addr[probe][0] == DS18S20MODEL)
+  {
+    return;
+  }
+
+  _oneWire->reset();
+  _oneWire->select(_addr[probe]);
+  _oneWire->write(PROBE_WRITE_SCRATCH);
+  _oneWire->write(PROBE_ALARM_HIGH);
+  _oneWire->write(PROBE_ALARM_LOW);
+  _oneWire->write(PROBE_CONFIG(bits));
+  _oneWire->reset();
+}
+
+uint8_t Probes::getResolution(unsigned int probe)
+{
+  return _resolution[probe];
+}
+
+/* Read the cached table: magic, the addresses, then their CRC. */
+bool Probes::load(void)
+{
+  uint8_t *bytes = (uint8_t *)(_addr);
+  int addr = EEPROM_PROBES;
+
+  if (EEPROM.read(addr++) != PROBES_MAGIC)
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < sizeof(_addr); i++)
+  {
+    bytes[i] = EEPROM.read(addr++);
+  }
+
+  if (EEPROM.read(addr) != OneWire::crc8(bytes, sizeof(_addr)))
+  {
+    memset(_addr, 0, sizeof(_addr));
+    return false;
+  }
+
+  return true;
+}
+
+/* Only bytes that changed are written, to spare the EEPROM. */
+void Probes::save(void)
+{
+  uint8_t *bytes = (uint8_t *)(_addr);
+  int addr = EEPROM_PROBES;
+
+  EEPROM.update(addr++, PROBES_MAGIC);
+
+  for (unsigned int i = 0; i < sizeof(_addr); i++)
+  {
+    EEPROM.update(addr++, bytes[i]);
+  }
+
+  EEPROM.update(addr, OneWire::crc8(bytes, sizeof(_addr)));
+}
+
+/* Check every bound probe still answers, without searching the bus, and
+ * free the roles of any that don't. False if any were freed or there are
+ * none bound at all. */
+bool Probes::verify(void)
+{
+  bool bound = false;
+  bool lost = false;
+
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    if (isBound(i))
+    {
+      if (!_sensors->isConnected(_addr[i]))
+      {
+        memset(_addr[i], 0, sizeof(DeviceAddress));
+        _resolution[i] = TEMPERATURE_PRECISION;
+        lost = true;
+        continue;
+      }
+
+      bound = true;
+    }
+  }
+
+  return (bound && !lost);
+}
+
+void Probes::bind(const uint8_t *addr)
+{
+  int free = -1;
+
+  for (unsigned int i = 0; i < NUM_PROBES; i++)
+  {
+    unsigned int role = bindOrder[i];
+
+    if (memcmp(_addr[role], addr, sizeof(DeviceAddress)) == 0)
+    {
+      return;
+    }
+
+    if (free < 0 && !isBound(role))
+    {
+      free = role;
+    }
+  }
+
+  if (free >= 0)
+  {
+    memcpy(_addr[free], addr, sizeof(DeviceAddress));
+    _sensors->setResolution(_addr[free], TEMPERATURE_PRECISION);
+    _resolution[free] = TEMPERATURE_PRECISION;
+  }
+}
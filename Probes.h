@@ -0,0 +1,82 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include <OneWire.h>
+#include <DallasTemperature.h>
+
+/* Probe roles. */
+#define PROBE_HLT      0
+#define PROBE_MASH     1
+#define PROBE_RIMS     2 // RIMS tube outlet
+#define PROBE_BK       3
+#define PROBE_CHILLER  4 // Chiller outlet
+#define NUM_PROBES     5
+
+/* Marks a valid address table in EEPROM. */
+#define PROBES_MAGIC  0xB7
+
+/* DS18B20 commands and configuration. */
+#define PROBE_WRITE_SCRATCH  0x4E
+#define PROBE_ALARM_HIGH     0x7F // Alarms aren't used
+#define PROBE_ALARM_LOW      0x80
+#define PROBE_CONFIG(bits)   ((((bits) - 9) << 5) | 0x1F)
+
+/* Binds the probes on the bus to vessel roles. The addresses are cached in
+ * EEPROM, so a boot only searches the bus when a cached probe has gone
+ * missing. A probe that no longer answers loses its role. Probes found by a
+ * search keep the role they already have, and new ones fill the free roles,
+ * the ones the controller uses first. Roles can also be assigned by hand. */
+class Probes
+{
+  public:
+    Probes(OneWire *oneWire, DallasTemperature *sensors);
+
+    void setup(void);
+    void discover(void);
+    bool assign(unsigned int from, unsigned int to);
+    void print(Print *out);
+
+    bool isBound(unsigned int probe);
+    const uint8_t *getAddress(unsigned int probe);
+
+    void setResolution(unsigned int probe, uint8_t bits);
+    uint8_t getResolution(unsigned int probe);
+
+  private:
+    bool load(void);
+    void save(void);
+    bool verify(void);
+    void bind(const uint8_t *addr);
+
+    OneWire *_oneWire;
+    DallasTemperature *_sensors;
+
+    DeviceAddress _addr[NUM_PROBES];
+    uint8_t _resolution[NUM_PROBES];
+};
+
+#endif
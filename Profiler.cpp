@@ -0,0 +1,222 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include "Profiler.h"
+
+Profiler::Profiler(const char * const *names, unsigned int numStages)
+: _names(names), _numStages(numStages)
+{
+  if (_numStages > PROFILER_MAX_STAGES)
+  {
+    _numStages = PROFILER_MAX_STAGES;
+  }
+
+  for (unsigned int i = 0; i < _numStages; i++)
+  {
+    _stages[i].start = 0;
+  }
+
+  /* No dump under way. */
+  _dumpStage = _numStages;
+  _dumpPiece = 0;
+
+  reset();
+}
+
+void Profiler::begin(unsigned int stage)
+{
+  _stages[stage].start = micros();
+}
+
+void Profiler::end(unsigned int stage)
+{
+  record(stage, micros() - _stages[stage].start);
+}
+
+void Profiler::record(unsigned int stage, unsigned long time)
+{
+  stageStats *s = &_stages[stage];
+
+  if (time < s->min)
+  {
+    s->min = time;
+  }
+
+  if (time > s->max)
+  {
+    s->max = time;
+  }
+
+  /* Halve the totals rather than overflow; the mean stays the same. */
+  if (s->sum + time < s->sum)
+  {
+    s->sum >>= 1;
+    s->count >>= 1;
+  }
+
+  s->sum += time;
+  s->count++;
+
+  /* Bucket by the number of significant bits. */
+  unsigned int bucket = 0;
+  while ((time != 0) && (bucket < (PROFILER_BUCKETS - 1)))
+  {
+    time >>= 1;
+    bucket++;
+  }
+
+  /* Saturate rather than wrap. */
+  if (s->buckets[bucket] != (unsigned int)(-1))
+  {
+    s->buckets[bucket]++;
+  }
+}
+
+/* Longest time recorded for a stage since the last reset. */
+unsigned long Profiler::getMax(unsigned int stage)
+{
+  return _stages[stage].max;
+}
+
+/* Clear the stats. Stages that have begun are left timing, as this is
+ * called from inside the loop they time. */
+void Profiler::reset(void)
+{
+  for (unsigned int i = 0; i < _numStages; i++)
+  {
+    stageStats *s = &_stages[i];
+
+    s->min = (unsigned long)(-1);
+    s->max = 0;
+    s->sum = 0;
+    s->count = 0;
+
+    for (unsigned int j = 0; j < PROFILER_BUCKETS; j++)
+    {
+      s->buckets[j] = 0;
+    }
+  }
+}
+
+/* Print one line per stage: name, count, min/mean/max in us, then the
+ * histogram buckets. */
+void Profiler::startDump(void)
+{
+  _dumpStage = 0;
+  _dumpPiece = 0;
+}
+
+/* Write the next pieces of a dump begun by startDump(), as many as the
+ * serial TX buffer has room for. Each stage is one line: its name, the
+ * count, min, mean and max, then the histogram. Returns true while there is
+ * more to write. */
+bool Profiler::dump(HardwareSerial *out)
+{
+  while (_dumpStage < _numStages)
+  {
+    stageStats *s = &_stages[_dumpStage];
+
+    if (out->availableForWrite() < PROFILER_PIECE_SIZE)
+    {
+      return true;
+    }
+
+    switch (_dumpPiece)
+    {
+      case 0:
+      {
+        out->print(_names[_dumpStage]);
+        out->print(':');
+        break;
+      }
+
+      case 1:
+      {
+        out->print(F(" n="));
+        out->print(s->count);
+        break;
+      }
+
+      case 2:
+      {
+        if (s->count)
+        {
+          out->print(F(" min="));
+          out->print(s->min);
+        }
+        break;
+      }
+
+      case 3:
+      {
+        if (s->count)
+        {
+          out->print(F(" mean="));
+          out->print(s->sum / s->count);
+        }
+        break;
+      }
+
+      case 4:
+      {
+        if (s->count)
+        {
+          out->print(F(" max="));
+          out->print(s->max);
+        }
+        break;
+      }
+
+      case 5:
+      {
+        out->print(F(" hist="));
+        break;
+      }
+
+      default:
+      {
+        /* Then one piece per bucket, and the end of the line. */
+        unsigned int bucket = _dumpPiece - 6;
+
+        if (bucket < PROFILER_BUCKETS)
+        {
+          out->print(' ');
+          out->print(s->buckets[bucket]);
+        }
+        else
+        {
+          out->println();
+          _dumpStage++;
+          _dumpPiece = 0;
+          continue;
+        }
+        break;
+      }
+    }
+
+    _dumpPiece++;
+  }
+
+  return false;
+}
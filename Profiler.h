@@ -0,0 +1,76 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#define PROFILER_MAX_STAGES  8
+
+/* Bucket n holds times of n significant bits, i.e. [2^(n-1), 2^n) us. The
+ * last bucket catches everything from ~16ms up. */
+#define PROFILER_BUCKETS  16
+
+/* A dump is written a piece at a time, a label and a number at most, so it
+ * can wait for room in the serial TX buffer rather than block the loop. */
+#define PROFILER_PIECE_SIZE  16
+
+/* Cheap micros()-based timing of the stages of the main loop: min, max,
+ * mean and a log2 histogram per stage, dumped on request. */
+class Profiler
+{
+  public:
+    Profiler(const char * const *names, unsigned int numStages);
+
+    void begin(unsigned int stage);
+    void end(unsigned int stage);
+    void record(unsigned int stage, unsigned long time);
+
+    unsigned long getMax(unsigned int stage);
+
+    void reset(void);
+    void startDump(void);
+    bool dump(HardwareSerial *out);
+
+  private:
+    struct stageStats
+    {
+      unsigned long start;
+      unsigned long min;
+      unsigned long max;
+      unsigned long sum;
+      unsigned long count;
+      unsigned int buckets[PROFILER_BUCKETS];
+    };
+
+    const char * const *_names;
+    unsigned int _numStages;
+
+    stageStats _stages[PROFILER_MAX_STAGES];
+
+    /* Next stage and piece of it for dump() to write. */
+    unsigned int _dumpStage;
+    unsigned int _dumpPiece;
+};
+
+#endif
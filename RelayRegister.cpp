@@ -0,0 +1,156 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include <avr/io.h>
+
+#include "RelayRegister.h"
+
+/* Bit-banged on any three pins. */
+RelayRegister::RelayRegister(uint8_t clockPin, uint8_t latchPin,
+                             uint8_t dataPin, uint8_t value)
+: _spi(false), _clockPin(clockPin), _latchPin(latchPin), _dataPin(dataPin),
+  _latchPort(NULL), _latchMask(0), _staged(value), _latched(value)
+{
+}
+
+/* Hardware SPI, with the latch on latchPin. */
+RelayRegister::RelayRegister(uint8_t latchPin, uint8_t value)
+: _spi(true), _clockPin(SCK), _latchPin(latchPin), _dataPin(MOSI),
+  _latchPort(NULL), _latchMask(0), _staged(value), _latched(value)
+{
+}
+
+void RelayRegister::setup(void)
+{
+  pinMode(_clockPin, OUTPUT);
+  pinMode(_latchPin, OUTPUT);
+  pinMode(_dataPin, OUTPUT);
+
+  _latchPort = portOutputRegister(digitalPinToPort(_latchPin));
+  _latchMask = digitalPinToBitMask(_latchPin);
+
+  if (_spi)
+  {
+    /* SS must be an output to stay in master mode. */
+    pinMode(SS, OUTPUT);
+
+    /* Master, MSB first, mode 0, clock / 2. */
+    SPCR = (1 << SPE) | (1 << MSTR);
+    SPSR = (1 << SPI2X);
+  }
+
+  /* Put the register into a known state. */
+  send(_staged);
+}
+
+/* Stage a bit. Nothing is sent until the next flush(). */
+void RelayRegister::write(uint8_t bit, bool value)
+{
+  if (value)
+  {
+    _staged |= (1 << bit);
+  }
+  else
+  {
+    _staged &= ~(1 << bit);
+  }
+}
+
+bool RelayRegister::read(uint8_t bit)
+{
+  return (_staged & (1 << bit)) != 0;
+}
+
+/* Latch the staged frame, if it differs from what is already out. Returns
+ * whether a frame was sent. */
+bool RelayRegister::flush(void)
+{
+  if (_staged != _latched)
+  {
+    send(_staged);
+    return true;
+  }
+
+  return false;
+}
+
+/* Send the latched frame again count times, leaving the relays as they are,
+ * and return how long that took in us. One frame is too quick to time with
+ * micros(), whose steps are 4us. */
+unsigned long RelayRegister::timeSend(unsigned int count)
+{
+  unsigned long start = micros();
+
+  for (unsigned int i = 0; i < count; i++)
+  {
+    send(_latched);
+  }
+
+  return micros() - start;
+}
+
+void RelayRegister::send(uint8_t value)
+{
+  if (_spi)
+  {
+    sendSPI(value);
+  }
+  else
+  {
+    digitalWrite(_latchPin, LOW);
+    shiftOut(_dataPin, _clockPin, MSBFIRST, value);
+    digitalWrite(_latchPin, HIGH);
+  }
+
+  _latched = value;
+}
+
+/* The peripheral shifts the byte out in 16 CPU cycles at clock / 2, so
+ * waiting for it costs less than an interrupt would. The latch is pulsed
+ * straight on its port. */
+void RelayRegister::sendSPI(uint8_t value)
+{
+  *_latchPort &= ~_latchMask;
+
+  SPDR = value;
+  while (!(SPSR & (1 << SPIF)));
+
+  *_latchPort |= _latchMask;
+}
+
+RelayBit::RelayBit(RelayRegister *relays, uint8_t bit, bool value)
+: _relays(relays), _bit(bit)
+{
+  _relays->write(_bit, value);
+}
+
+void RelayBit::Write(bool value)
+{
+  _relays->write(_bit, value);
+}
+
+bool RelayBit::Read(void)
+{
+  return _relays->read(_bit);
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RELAY_REGISTER_H
+#define RELAY_REGISTER_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+/* 74HC595 driving the relay board. Bit changes are staged and go out
+ * together as one latched frame when flush() is called, so relays changed
+ * in the same loop pass all switch on the same latch edge.
+ *
+ * The frame is either bit-banged on any three pins, or clocked out by the
+ * hardware SPI peripheral (MOSI/SCK) with only the latch on its own pin. */
+class RelayRegister
+{
+  public:
+    RelayRegister(uint8_t clockPin, uint8_t latchPin, uint8_t dataPin,
+                  uint8_t value);
+    RelayRegister(uint8_t latchPin, uint8_t value);
+
+    void setup(void);
+
+    void write(uint8_t bit, bool value);
+    bool read(uint8_t bit);
+
+    bool flush(void);
+
+    unsigned long timeSend(unsigned int count);
+
+  private:
+    void send(uint8_t value);
+    void sendSPI(uint8_t value);
+
+    bool _spi;
+
+    uint8_t _clockPin;
+    uint8_t _latchPin;
+    uint8_t _dataPin;
+
+    /* Latch pin port, so it can be pulsed without digitalWrite(). */
+    volatile uint8_t *_latchPort;
+    uint8_t _latchMask;
+
+    /* Frame being built, and the frame last latched. */
+    uint8_t _staged;
+    uint8_t _latched;
+};
+
+/* A single relay on a RelayRegister. Drop-in for ShiftBitDevice. */
+class RelayBit
+{
+  public:
+    RelayBit(RelayRegister *relays, uint8_t bit, bool value);
+
+    void Write(bool value);
+    bool Read(void);
+
+  private:
+    RelayRegister *_relays;
+    uint8_t _bit;
+};
+
+#endif
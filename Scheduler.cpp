@@ -0,0 +1,155 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include "Scheduler.h"
+
+Scheduler::Scheduler()
+: _numTasks(0), _nextTask(SCHEDULER_NO_TASK), _nextDeadline(0)
+{
+}
+
+/* Register a task. A period of zero makes it a one-shot task that stops
+ * after it runs. Tasks are registered stopped. */
+int Scheduler::addTask(taskCallback callback, void *cookie, unsigned long period)
+{
+  if (_numTasks >= SCHEDULER_MAX_TASKS)
+  {
+    return SCHEDULER_NO_TASK;
+  }
+
+  task *t = &_tasks[_numTasks];
+  t->callback = callback;
+  t->cookie = cookie;
+  t->period = period;
+  t->deadline = 0;
+  t->active = false;
+
+  return _numTasks++;
+}
+
+/* (Re)arm a task to run delay ms from now. */
+void Scheduler::start(int task, unsigned long delay)
+{
+  unsigned long now = millis();
+
+  _tasks[task].deadline = now + delay;
+  _tasks[task].active = true;
+
+  updateNext(now);
+}
+
+void Scheduler::stop(int task)
+{
+  _tasks[task].active = false;
+
+  updateNext(millis());
+}
+
+/* Push an armed task's deadline back. */
+void Scheduler::postpone(int task, unsigned long delay)
+{
+  _tasks[task].deadline += delay;
+
+  updateNext(millis());
+}
+
+bool Scheduler::isActive(int task)
+{
+  return _tasks[task].active;
+}
+
+/* Run every task that is due. Returns false straight away if nothing is. */
+bool Scheduler::run(void)
+{
+  unsigned long now = millis();
+
+  if ((_nextTask == SCHEDULER_NO_TASK) || !isDue(now, _nextDeadline))
+  {
+    return false;
+  }
+
+  for (int i = 0; i < _numTasks; i++)
+  {
+    task *t = &_tasks[i];
+
+    if (t->active && isDue(now, t->deadline))
+    {
+      if (t->period)
+      {
+        t->deadline += t->period;
+
+        /* Don't try to catch up on missed runs. */
+        if (isDue(now, t->deadline))
+        {
+          t->deadline = now + t->period;
+        }
+      }
+      else
+      {
+        t->active = false;
+      }
+
+      t->callback(t->cookie);
+    }
+  }
+
+  /* Callbacks may have started and stopped tasks. */
+  updateNext(millis());
+
+  return true;
+}
+
+/* Has deadline been reached? Correct as long as the two are within about
+ * 24 days of each other, however millis() has wrapped. */
+bool Scheduler::isDue(unsigned long now, unsigned long deadline)
+{
+  return (long)(now - deadline) >= 0;
+}
+
+void Scheduler::updateNext(unsigned long now)
+{
+  long soonest = 0;
+
+  _nextTask = SCHEDULER_NO_TASK;
+
+  for (int i = 0; i < _numTasks; i++)
+  {
+    if (_tasks[i].active)
+    {
+      /* Compare relative to now so the order survives the rollover. */
+      long remaining = (long)(_tasks[i].deadline - now);
+
+      if ((_nextTask == SCHEDULER_NO_TASK) || (remaining < soonest))
+      {
+        _nextTask = i;
+        soonest = remaining;
+      }
+    }
+  }
+
+  if (_nextTask != SCHEDULER_NO_TASK)
+  {
+    _nextDeadline = _tasks[_nextTask].deadline;
+  }
+}
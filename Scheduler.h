@@ -0,0 +1,66 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#define SCHEDULER_MAX_TASKS  12
+#define SCHEDULER_NO_TASK    (-1)
+
+typedef void (*taskCallback)(void *cookie);
+
+/* Cooperative scheduler for the periodic and one-shot work done from the
+ * main loop. Deadlines are compared with wrap-safe arithmetic so they keep
+ * working across the millis() rollover. */
+class Scheduler
+{
+  public:
+    Scheduler();
+
+    int addTask(taskCallback callback, void *cookie, unsigned long period);
+
+    void start(int task, unsigned long delay);
+    void stop(int task);
+    void postpone(int task, unsigned long delay);
+    bool isActive(int task);
+
+    bool run(void);
+
+    static bool isDue(unsigned long now, unsigned long deadline);
+
+  private:
+    struct task
+    {
+      taskCallback callback;
+      void *cookie;
+      unsigned long period;
+      unsigned long deadline;
+      bool active;
+    };
+
+    void updateNext(unsigned long now);
+
+    task _tasks[SCHEDULER_MAX_TASKS];
+    int _numTasks;
+
+    /* Earliest deadline, so an idle pass is a single compare. */
+    int _nextTask;
+    unsigned long _nextDeadline;
+};
+
+#endif
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include "TerminalBackend.h"
+
+TerminalBackend::TerminalBackend(Print *out)
+: _out(out)
+{
+}
+
+void TerminalBackend::begin(uint8_t cols, uint8_t rows)
+{
+  /* Clear the terminal and draw a frame round the screen. */
+  _out->print(F("\x1b[2J"));
+
+  for (uint8_t y = 0; y < rows + 2; y++)
+  {
+    moveTo(0, y);
+
+    bool edge = (y == 0) || (y == rows + 1);
+    _out->print(edge ? '+' : '|');
+    for (uint8_t x = 0; x < cols; x++)
+    {
+      _out->print(edge ? '-' : ' ');
+    }
+    _out->print(edge ? '+' : '|');
+  }
+
+  /* Keep other output scrolling below the frame, and start it there. */
+  _out->print(F("\x1b["));
+  _out->print(rows + 3);
+  _out->print('r');
+  moveTo(0, rows + 2);
+}
+
+void TerminalBackend::write(uint8_t x, uint8_t y, const char *buf,
+                            uint8_t length)
+{
+  /* Inside the frame, then back to wherever other output had got to. */
+  _out->print(F("\x1b" "7"));
+  moveTo(x + 1, y + 1);
+  _out->write((const uint8_t *)buf, length);
+  _out->print(F("\x1b" "8"));
+}
+
+void TerminalBackend::moveTo(uint8_t x, uint8_t y)
+{
+  _out->print(F("\x1b["));
+  _out->print(y + 1);
+  _out->print(';');
+  _out->print(x + 1);
+  _out->print('H');
+}
@@ -0,0 +1,48 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TERMINAL_BACKEND_H
+#define TERMINAL_BACKEND_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include "DisplayBackend.h"
+
+/* Draws the screen on an ANSI terminal, in a box, at the top left. Each run
+ * is one cursor move and the text. Anything else printed to the same port
+ * scrolls in the lines below the box, so text reports don't overwrite the
+ * screen. */
+class TerminalBackend : public DisplayBackend
+{
+  public:
+    TerminalBackend(Print *out);
+
+    void begin(uint8_t cols, uint8_t rows);
+    void write(uint8_t x, uint8_t y, const char *buf, uint8_t length);
+
+  private:
+    void moveTo(uint8_t x, uint8_t y);
+
+    Print *_out;
+};
+
+#endif
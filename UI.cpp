@@ -28,100 +28,127 @@
 #include "UI.h"
 
 UI::UI(BrewBot *brewBot)
-: _brewBot(brewBot), _buttons(Buttons(handleButtons, this)),
-  _name({ "MASH  ", "SPARGE", "BOIL  ", "DISINF", "COOL  ", "      " }),
-  _step(0), _probeTemp(0.00)
+: _brewBot(brewBot), _display(&brewBot->lcd),
+  _buttons(Buttons(handleButtons, this)), _state(STATE_INIT),
+  _beeper(&brewBot->scheduler, &brewBot->devBeeper),
+  _indicator(&brewBot->scheduler, &brewBot->devIndicator),
+  _name({ "MASH  ", "SPARGE", "BOIL  ", "DISINF", "COOL  ", "TUNE R",
+          "TUNE B", "      " }),
+  _probe(PROBE_RIMS), _blink(true), _probeTemp(0),
+  _tuneVessel(VESSEL_NONE), _tuning(false), _tuneMinutes(0),
+  _tuneSave(false)
 {
 }
 
 /* UI setup function. */
 void UI::setup(void)
 {
-  unsigned long start_time = millis();
-
   /* Setup display. */
   _display.setup();
 
+  /* Setup buttons. */
+  _buttons.setup();
+
   /* Start-up message. */
   _display.printStartupMessage();
 
-  /* Turn on indicator light. */
-  _brewBot->devIndicator.Write(true);
+  /* Register timed work. */
+  _taskBlink = _brewBot->scheduler.addTask(tickBlink, this, BLINK_TIME);
+  _taskTimer = _brewBot->scheduler.addTask(tickTimer, this, TIMER_TIME);
+  _taskReminder = _brewBot->scheduler.addTask(tickReminder, this, REMINDER_TIME);
+  _taskState = _brewBot->scheduler.addTask(tickState, this, 0);
+  _taskDisplay = _brewBot->scheduler.addTask(tickDisplay, this, 0);
+
+  bool players = _beeper.setup() && _indicator.setup();
+
+  if (!players || (_taskBlink == SCHEDULER_NO_TASK) ||
+      (_taskTimer == SCHEDULER_NO_TASK) ||
+      (_taskReminder == SCHEDULER_NO_TASK) ||
+      (_taskState == SCHEDULER_NO_TASK) ||
+      (_taskDisplay == SCHEDULER_NO_TASK))
+  {
+    _brewBot->halt(F("UI tasks: raise SCHEDULER_MAX_TASKS"));
+  }
+
+  /* Turn on indicator light for as long as the message is up. */
+  _indicator.queue(true, UI_STARTUP_TIME);
 
-  /* Turn on start-up beep. */
-  _brewBot->devBeeper.Write(true);
+  /* Start-up beep. */
+  _beeper.queue(true, BEEP_TIME * 2);
 
   /* Setup default times and temps. */
-  for (_function = 0; _function < UI_MAX_FUNCS; _function++)
+  for (unsigned int function = 0; function < UI_MAX_FUNCS; function++)
   {
-    for (_step = 0; _step < UI_MAX_STEPS; _step++)
-    {
-      unsigned long time;
+    unsigned long time;
 
-      switch (_function)
+    switch (function)
+    {
+      case UI_FUNC_BOIL:
       {
-        case UI_FUNC_BOIL:
-        {
-          time = UI_TIME_BOIL;
-          break;
-        }
-        case UI_FUNC_DISINF:
-        {
-          time = UI_TIME_DISINF;
-          break;
-        }
-        case UI_FUNC_COOL:
-        {
-          time = UI_TIME_COOL;
-          break;
-        }
-        default:
-        {
-          time = UI_TIME_DEFAULT;
-          break;
-        }
+        time = UI_TIME_BOIL;
+        break;
+      }
+      case UI_FUNC_DISINF:
+      {
+        time = UI_TIME_DISINF;
+        break;
+      }
+      case UI_FUNC_COOL:
+      {
+        time = UI_TIME_COOL;
+        break;
+      }
+      default:
+      {
+        time = UI_TIME_DEFAULT;
+        break;
       }
-
-      setTime(time);
-      setTargetTemp(UI_TEMP_DEFAULT);
     }
-  }
-
-  _function = 0;
-  _step = 0;
 
-  /* XXX: Some delay so the init message is visible. */
-  while (millis() < start_time + 2000)
-  {
-    if (millis() >= start_time + (BEEP_TIME * 2))
+    for (unsigned int step = 0; step < UI_MAX_STEPS; step++)
     {
-      _brewBot->devBeeper.Write(false);
+      _time[function][step] = time;
+      _targetTemp[function][step] = UI_TEMP_DEFAULT;
     }
 
-    delay(100);
+    _numSteps[function] = 1;
+    _step[function] = 0;
+    _running[function] = false;
+    _done[function] = false;
+    _preheating[function] = false;
+    _ramping[function] = false;
   }
 
-  /* Turn off indicator light. */
-  _brewBot->devIndicator.Write(false);
+  _function = 0;
 
-  /* Set initial state. */
+  _brewBot->scheduler.start(_taskBlink, 0);
+
+  /* Set initial state once the init message has been seen. */
   _menuPosition = UI_FUNC_MASH;
-  setState(STATE_MENU);
+  setStateLater(STATE_MENU, UI_STARTUP_TIME);
 }
 
 /* Main loop */
 void UI::loop(void)
 {
+  /* Look for button presses. */
+  _buttons.update();
+
+  /* Keep every running function going, whichever one is on display. */
+  for (unsigned int function = 0; function < UI_MAX_FUNCS; function++)
+  {
+    if (_running[function] && !_done[function])
+    {
+      runFunction(function);
+    }
+  }
+
   switch (_state)
   {
     case STATE_MENU:
     {
-      /* Blink the menu item. */
-      displayBlinkMenuItem();
-
-      /* Look for button presses. */
-      _buttons.update();
-
+      /* Show what the vessels are up to while waiting for keys. */
+      displayStatus();
       break;
     }
 
@@ -131,36 +158,23 @@ void UI::loop(void)
     case STATE_DISINF:
     case STATE_COOL:
     {
-      setState(STATE_TIME);
-
+      /* Waiting for the pause before editing to finish. */
       break;
     }
 
     case STATE_TIME:
     {
-      /* Blink the time. */
-      displayBlinkTime();
-
       /* Update the probe temperature. */
       displayProbeTemp();
 
-      /* Look for button presses. */
-      _buttons.update();
-
       break;
     }
 
     case STATE_TEMP:
     {
-      /* Blink the target temperature. */
-      displayBlinkTemp();
-
       /* Update the probe temperature. */
       displayProbeTemp();
 
-      /* Look for button presses. */
-      _buttons.update();
-
       break;
     }
 
@@ -178,73 +192,45 @@ void UI::loop(void)
 
     case STATE_EXEC:
     {
-      /* Blink the ":" in the time. */
-      displayBlinkIndicator();
-
       /* Update the probe temperature. */
       /* XXX: Plumb into element control? */
       displayProbeTemp();
 
-      /* Update the timer. */
-      displayTimer();
-
-      /* Look for button presses. */
-      _buttons.update();
-
-      /* Check if this step is done. */
-      if (_time[_function][_step] == 0)
-      {
-        /* Check if there are any other steps. */
-        if (nextStep())
-        {
-          /* Start beeping. */
-          unsigned long now = millis();
-          _brewBot->devBeeper.Write(true);
-
-          /* Don't tick for 2 seconds.
-           * One second to display zero, then another second to display the
-           * start of the next timer. */
-          _nextTickTimer = now + (TIMER_TIME * 2);
-
-          /* Finishing stalling and beeping. */
-          while (now + BEEP_TIME > millis());
-          _brewBot->devBeeper.Write(false);
-
-          /* Wait for "0:00" to display for one second. */
-          while (now + (BEEP_TIME *2) > millis());
+      break;
+    }
 
-          /* Update display. */
-          display();
-        }
-        else
-        {
-          setState(STATE_DONE);
-        }
-      }
+    case STATE_DONE:
+    {
+      /* Update the probe temperature. */
+      /* XXX: Plumb into RIMS element control? */
+      displayProbeTemp();
 
       break;
     }
 
-    case STATE_DONE:
+    case STATE_TUNE:
     {
-      /* Beep if we still need to. */
-      if (_numBeeps > 0)
+      /* Update the probe temperature, unless the gains are showing. */
+      if (!_tuneSave)
       {
-        if (updateBeeper())
-        {
-          _numBeeps--;
-        }
+        displayProbeTemp();
       }
 
-      /* Update the reminder timer. */
-      updateReminder();
-
-      /* Update the probe temperature. */
-      /* XXX: Plumb into RIMS element control? */
-      displayProbeTemp();
+      if (_tuning)
+      {
+        /* Show how long it has been going. */
+        unsigned long minutes = _brewBot->autotune.getElapsed() / 60;
+        if (minutes != _tuneMinutes)
+        {
+          _tuneMinutes = minutes;
+          _display.printTime(_tuneMinutes);
+        }
 
-      /* Look for button presses. */
-      _buttons.update();
+        if (_brewBot->autotune.getState() != AUTOTUNE_RUNNING)
+        {
+          finishTune();
+        }
+      }
 
       break;
     }
@@ -252,54 +238,88 @@ void UI::loop(void)
     default:
       break;
   }
+
+  /* Push any changes out to the LCD. */
+  _display.flush();
 }
 
 void UI::startFunction()
 {
+  /* One minute timer serves every running function. */
+  if (!anyRunning())
+  {
+    _brewBot->scheduler.start(_taskTimer, TIMER_TIME);
+  }
+
+  _running[_function] = true;
+  _done[_function] = false;
+
+  /* The PID needs readings from the probe. */
+  if (_function != UI_FUNC_COOL)
+  {
+    _brewBot->subscribeProbe(getProbe(_function), PROBE_USER_PID);
+  }
+
   /* Do function specific stuff. */
   switch (_function)
   {
     case UI_FUNC_MASH:
     case UI_FUNC_SPARGE:
     {
-      /* Turn on pump. */
-      _brewBot->devPump.Write(true);
-
-      /* Turn on PID device. */
-      _brewBot->devPIDRIMS.enable(true);
+      /* Turn on PID. */
+      _brewBot->pidRIMS.enable(true);
 
       break;
     }
 
     case UI_FUNC_BOIL:
+    case UI_FUNC_DISINF:
     {
-      /* Turn on fans. */
-      _brewBot->devFan.Write(true);
-
-      /* Turn on PID device. */
-      _brewBot->devPIDBK.enable(true);
+      /* Turn on PID. */
+      _brewBot->pidBK.enable(true);
 
       break;
     }
 
-    case UI_FUNC_DISINF:
-    {
-      /* Turn on fans. */
-      _brewBot->devFan.Write(true);
+    default:
+      break;
+  }
+
+  /* Turn on pump and fans. */
+  updateOutputs();
+}
 
-      /* Turn on pump. */
-      _brewBot->devPump.Write(true);
+void UI::stopFunction()
+{
+  unsigned int probe = getProbe(_function);
 
-      /* Turn on PID device. */
-      _brewBot->devPIDBK.enable(true);
+  _running[_function] = false;
+  _done[_function] = false;
+  _preheating[_function] = false;
+  _ramping[_function] = false;
+
+  switch (_function)
+  {
+    case UI_FUNC_MASH:
+    case UI_FUNC_SPARGE:
+    {
+      /* Turn off PID. */
+      _brewBot->pidRIMS.enable(false);
+
+      /* Turn off element. */
+      _brewBot->modRIMS.setDemand(0.00);
 
       break;
     }
 
-    case UI_FUNC_COOL:
+    case UI_FUNC_BOIL:
+    case UI_FUNC_DISINF:
     {
-      /* Turn on pump. */
-      _brewBot->devPump.Write(true);
+      /* Turn off PID. */
+      _brewBot->pidBK.enable(false);
+
+      /* Turn off element. */
+      _brewBot->modBK.setDemand(0.00);
 
       break;
     }
@@ -307,62 +327,245 @@ void UI::startFunction()
     default:
       break;
   }
+
+  /* Turn off pump and fans, unless something else still needs them. */
+  updateOutputs();
+
+  /* Nothing is being held any more. */
+  _brewBot->setProbeTarget(probe, PROBE_NO_TARGET);
+  _brewBot->unsubscribeProbe(probe, PROBE_USER_PID);
+
+  if (!anyRunning())
+  {
+    _brewBot->scheduler.stop(_taskTimer);
+  }
+
+  /* Stop reminding once nothing is left done. */
+  if (!anyDone())
+  {
+    _brewBot->scheduler.stop(_taskReminder);
+    _beeper.set(false);
+  }
+
+  /* Stop blinking. */
+  _display.printIndicator();
+
+  /* Turn off indicator light. */
+  _indicator.set(anyRunning());
 }
 
-void UI::stopFunction()
+/* Go back to a function that was left running. */
+void UI::resumeFunction(unsigned int function)
 {
-  switch (_function)
+  /* Stop blinking. */
+  _display.printMenu(_name, _menuPosition);
+
+  setFunction(function);
+  setProbe(getProbe(function));
+
+  setState(_done[function] ? STATE_DONE : STATE_EXEC);
+}
+
+/* Work through a running function's steps. This is done for every running
+ * function, whether or not it is the one on display. */
+void UI::runFunction(unsigned int function)
+{
+  unsigned int step = _step[function];
+  bool shown = ((function == _function) && (_state == STATE_EXEC));
+
+  /* Let the probe know what it is being held to. */
+  _brewBot->setProbeTarget(getProbe(function), _targetTemp[function][step]);
+
+  /* Get going on the next step's heat-up. */
+  preheat(function);
+
+  /* Show the ramp while out of band, and the step once in it. */
+  if (isHeld(function) == _ramping[function])
   {
-    case UI_FUNC_MASH:
-    case UI_FUNC_SPARGE:
+    _ramping[function] = !_ramping[function];
+
+    if (shown)
     {
-      /* Turn off PID device. */
-      _brewBot->devPIDRIMS.enable(false);
+      displayPhase();
+    }
+  }
 
-      /* Turn off element. */
-      _brewBot->devElementRIMSDC.Write(false);
+  /* Check if this step is done. */
+  if (_time[function][step] != 0)
+  {
+    return;
+  }
 
-      /* Turn off pump. */
-      _brewBot->devPump.Write(false);
+  logStep(function);
 
-      break;
-    }
+  /* Check if there are any other steps. */
+  if (nextStep(function))
+  {
+    /* Beep. */
+    _beeper.queue(true, BEEP_TIME);
 
-    case UI_FUNC_DISINF:
+    /* Update display once "0:00" has been up for one second. */
+    if (shown)
     {
-      /* Turn off pump. */
-      _brewBot->devPump.Write(false);
+      _brewBot->scheduler.start(_taskDisplay, BEEP_TIME * 2);
     }
-    case UI_FUNC_BOIL:
-    {
-      /* Turn off PID device. */
-      _brewBot->devPIDBK.enable(false);
 
-      /* Turn off element. */
-      _brewBot->devElementBKDC.Write(false);
+    return;
+  }
 
-      /* Turn off fans. */
-      _brewBot->devFan.Write(false);
+  /* Put the timer into "done" mode. The PID keeps holding the last step
+   * until the function is stopped. */
+  _done[function] = true;
+  _brewBot->scheduler.start(_taskReminder, REMINDER_TIME);
+  _beeper.pulse(BEEP_TIME, BEEP_TIME, 3);
 
-      break;
+  if (shown)
+  {
+    setState(STATE_DONE);
+  }
+}
+
+/* Only one function can use a vessel's probe at a time. Beeps if this one
+ * can't start. */
+bool UI::canStart(void)
+{
+  if (getRunning(getProbe(_function)) >= 0)
+  {
+    _beeper.pulse(BEEP_TIME, BEEP_TIME, 2);
+    return false;
+  }
+
+  return true;
+}
+
+/* The pump and fans are shared, so they run for as long as anything needs
+ * them. */
+void UI::updateOutputs(void)
+{
+  bool pump = (_tuning && (_tuneVessel == VESSEL_RIMS));
+  bool fan = (_tuning && (_tuneVessel == VESSEL_BK));
+
+  pump = pump || _running[UI_FUNC_MASH] || _running[UI_FUNC_SPARGE] ||
+         _running[UI_FUNC_DISINF] || _running[UI_FUNC_COOL];
+  fan = fan || _running[UI_FUNC_BOIL] || _running[UI_FUNC_DISINF];
+
+  _brewBot->devPump.Write(pump);
+  _brewBot->devFan.Write(fan);
+}
+
+/* Function running on a probe, or -1. */
+int UI::getRunning(unsigned int probe)
+{
+  for (unsigned int function = 0; function < UI_MAX_FUNCS; function++)
+  {
+    if (_running[function] && (getProbe(function) == probe))
+    {
+      return function;
     }
+  }
 
-    case UI_FUNC_COOL:
+  return -1;
+}
+
+bool UI::anyRunning(void)
+{
+  for (unsigned int function = 0; function < UI_MAX_FUNCS; function++)
+  {
+    if (_running[function])
     {
-      /* Turn off pump. */
-      _brewBot->devPump.Write(false);
-      break;
+      return true;
     }
+  }
 
-    default:
-      break;
+  return false;
+}
+
+bool UI::anyDone(void)
+{
+  for (unsigned int function = 0; function < UI_MAX_FUNCS; function++)
+  {
+    if (_done[function])
+    {
+      return true;
+    }
   }
 
-  /* Stop blinking. */
-  _display.printIndicator();
+  return false;
+}
+
+/* Relay autotune the chosen vessel, with the pump or fans running as they
+ * would be for its functions. */
+void UI::startTune()
+{
+  _brewBot->startTune(_tuneVessel, UI_TUNE_TEMP);
+  _tuning = true;
+
+  /* Turn on pump or fans. */
+  updateOutputs();
+
+  /* Turn on indicator light. */
+  _indicator.set(true);
+}
+
+void UI::stopTune()
+{
+  if (!_tuning)
+  {
+    return;
+  }
+
+  _brewBot->stopTune();
+  _tuning = false;
+
+  /* Turn off pump or fans, unless a function still needs them. */
+  updateOutputs();
 
   /* Turn off indicator light. */
-  _brewBot->devIndicator.Write(false);
+  _indicator.set(anyRunning());
+}
+
+/* Show how the tune went. Gains from a finished tune are shown to be
+ * saved or not, see keyPressTune(). */
+void UI::finishTune()
+{
+  bool done = (_brewBot->autotune.getState() == AUTOTUNE_DONE);
+
+  stopTune();
+
+  if (done)
+  {
+    _tuneGains.kp = _brewBot->autotune.getKp();
+    _tuneGains.ki = _brewBot->autotune.getKi();
+    _tuneGains.kd = 0.00;
+    _tuneSave = true;
+
+    _display.printGains(_tuneGains.kp, _tuneGains.ki);
+  }
+  else
+  {
+    _display.printFunction("FAILED", UI_TUNE_TEMP, getProbeTemp(),
+                           _tuneMinutes, false);
+  }
+
+  _beeper.pulse(BEEP_TIME, BEEP_TIME, 3);
+}
+
+/* Save the tuned gains for the vessel's functions, in the band the tune
+ * was done in. */
+void UI::saveTune()
+{
+  unsigned int band = BrewBot::getGainBand(UI_TUNE_TEMP);
+
+  if (_tuneVessel == VESSEL_RIMS)
+  {
+    _brewBot->saveGains(UI_FUNC_MASH, band, &_tuneGains);
+    _brewBot->saveGains(UI_FUNC_SPARGE, band, &_tuneGains);
+  }
+  else
+  {
+    _brewBot->saveGains(UI_FUNC_BOIL, band, &_tuneGains);
+    _brewBot->saveGains(UI_FUNC_DISINF, band, &_tuneGains);
+  }
 }
 
 void UI::setState(UI::states state)
@@ -371,12 +574,13 @@ void UI::setState(UI::states state)
   {
     case STATE_MENU:
     {
-      /* Specific transition stuff based on previous state. */
+      /* Specific transition stuff based on previous state. Functions left
+       * from STATE_EXEC or STATE_DONE carry on running. */
       switch(_state)
       {
-        case STATE_DONE:
+        case STATE_TUNE:
         {
-          stopFunction();
+          stopTune();
           break;
         }
 
@@ -397,13 +601,13 @@ void UI::setState(UI::states state)
       /* Setup sub-function. */
       setFunction(UI_FUNC_MASH);
       setNumSteps(UI_MAX_STEPS);
-      setProbeDev(&(_brewBot->devProbeRIMS));
+      setProbe(PROBE_RIMS);
 
       /* Display sub-function. */
       display();
 
       /* Pause so things don't happen too quickly. */
-      delay(500);
+      setStateLater(STATE_TIME, UI_PAUSE_TIME);
 
       break;
     }
@@ -416,13 +620,13 @@ void UI::setState(UI::states state)
       /* Setup sub-function. */
       setFunction(UI_FUNC_SPARGE);
       setNumSteps(1);
-      setProbeDev(&(_brewBot->devProbeRIMS));
+      setProbe(PROBE_RIMS);
 
       /* Display sub-function. */
       display();
 
       /* Pause so things don't happen too quickly. */
-      delay(500);
+      setStateLater(STATE_TIME, UI_PAUSE_TIME);
 
       break;
     }
@@ -435,13 +639,13 @@ void UI::setState(UI::states state)
       /* Setup sub-function. */
       setFunction(UI_FUNC_BOIL);
       setNumSteps(UI_MAX_STEPS);
-      setProbeDev(&(_brewBot->devProbeBK));
+      setProbe(PROBE_BK);
 
       /* Display sub-function. */
       display();
 
       /* Pause so things don't happen too quickly. */
-      delay(500);
+      setStateLater(STATE_TIME, UI_PAUSE_TIME);
 
       break;
     }
@@ -454,13 +658,13 @@ void UI::setState(UI::states state)
       /* Setup sub-function. */
       setFunction(UI_FUNC_DISINF);
       setNumSteps(1);
-      setProbeDev(&(_brewBot->devProbeBK));
+      setProbe(PROBE_BK);
 
       /* Display sub-function. */
       display();
 
       /* Pause so things don't happen too quickly. */
-      delay(500);
+      setStateLater(STATE_TIME, UI_PAUSE_TIME);
 
       break;
     }
@@ -473,13 +677,13 @@ void UI::setState(UI::states state)
       /* Setup sub-function. */
       setFunction(UI_FUNC_COOL);
       setNumSteps(1);
-      setProbeDev(&(_brewBot->devProbeBK));
+      setProbe(PROBE_BK);
 
       /* Display sub-function. */
       display();
 
       /* Pause so things don't happen too quickly. */
-      delay(500);
+      setStateLater(STATE_TIME, UI_PAUSE_TIME);
 
       break;
     }
@@ -499,30 +703,24 @@ void UI::setState(UI::states state)
 
         case STATE_EXEC:
         {
-          /* Start beeping. */
-          unsigned long now = millis();
-          _brewBot->devBeeper.Write(true);
+          /* Beep. */
+          _beeper.queue(true, BEEP_TIME);
 
           /* Do function specific stuff. */
           stopFunction();
 
-          /* Finishing stalling and beeping. */
-          while (now + BEEP_TIME > millis());
-          _brewBot->devBeeper.Write(false);
-
           break;
         }
 
         case STATE_DONE:
         {
-          /* Start beeping. */
-          unsigned long now = millis();
-          _brewBot->devBeeper.Write(true);
+          /* Beep. */
+          _beeper.queue(true, BEEP_TIME);
 
           stopFunction();
 
           /* Move to the first step. */
-          setStep(0);
+          setStep(_function, 0);
 
           /* Reset to default time. */
           setTime(UI_TIME_DEFAULT);
@@ -530,10 +728,6 @@ void UI::setState(UI::states state)
           /* Reset display. */
           display();
 
-          /* Finishing stalling and beeping. */
-          while (now + BEEP_TIME > millis());
-          _brewBot->devBeeper.Write(false);
-
           break;
         }
       }
@@ -572,7 +766,7 @@ void UI::setState(UI::states state)
         }
       }
 
-      if (setStep(_step + 1))
+      if (setStep(_function, _step[_function] + 1))
       {
         display();
       }
@@ -594,7 +788,7 @@ void UI::setState(UI::states state)
         }
       }
 
-      if (setStep(_step - 1))
+      if (setStep(_function, _step[_function] - 1))
       {
         display();
       }
@@ -624,34 +818,36 @@ void UI::setState(UI::states state)
         }
       }
 
-      /* Start beeping. */
-      unsigned long now = millis();
-      _brewBot->devBeeper.Write(true);
+      /* A function resumed from the menu is already going. */
+      if (!_running[_function])
+      {
+        /* Beep. */
+        _beeper.queue(true, BEEP_TIME);
 
-      startFunction();
+        startFunction();
 
-      /* Move to first (active) step. */
-      for (unsigned int i = 0; i < UI_MAX_STEPS; i++)
-      {
-        if (_time[_function][i])
+        /* Nothing has been ramped or held yet. */
+        memset(_rampTime[_function], 0, sizeof(_rampTime[_function]));
+        memset(_holdTime[_function], 0, sizeof(_holdTime[_function]));
+
+        /* Move to first (active) step. */
+        for (unsigned int i = 0; i < UI_MAX_STEPS; i++)
         {
-          setStep(i);
-          break;
+          if (_time[_function][i])
+          {
+            setStep(_function, i);
+            break;
+          }
         }
       }
 
       display();
 
       /* Turn on indicator light. */
-      _brewBot->devIndicator.Write(true);
-
-      /* Start the timer. */
-      _nextTickTimer = now + TIMER_TIME;
-      _nextTickBlink = now + BLINK_TIME;
+      _indicator.set(true);
 
-      /* Finishing stalling and beeping. */
-      while (now + BEEP_TIME > millis());
-      _brewBot->devBeeper.Write(false);
+      /* Blink the ":" in the time. */
+      _brewBot->scheduler.start(_taskBlink, BLINK_TIME);
 
       break;
     }
@@ -676,13 +872,34 @@ void UI::setState(UI::states state)
 
           break;
         }
+
+        case STATE_MENU:
+        {
+          /* Resumed a function that finished while off display. */
+          display();
+
+          break;
+        }
       }
 
-      /* Put the timer into "done" mode. */
-      unsigned long now = millis();
-      _nextTickReminder = now + REMINDER_TIME;
-      _nextTickBeeper = now + BEEP_TIME;
-      _numBeeps = 6;
+      break;
+    }
+
+    case STATE_TUNE:
+    {
+      /* Stop blinking. */
+      _display.printMenu(_name, _menuPosition);
+
+      setProbe((_tuneVessel == VESSEL_RIMS) ? PROBE_RIMS : PROBE_BK);
+
+      _tuneMinutes = 0;
+      _display.printFunction(_name[_menuPosition], UI_TUNE_TEMP,
+                             getProbeTemp(), _tuneMinutes, false);
+
+      /* Beep. */
+      _beeper.queue(true, BEEP_TIME);
+
+      startTune();
 
       break;
     }
@@ -695,6 +912,13 @@ void UI::setState(UI::states state)
   _state = state;
 }
 
+/* Switch state after a delay, without holding up the loop. */
+void UI::setStateLater(UI::states state, unsigned long delay)
+{
+  _nextState = state;
+  _brewBot->scheduler.start(_taskState, delay);
+}
+
 /* Done mode key press handler. */
 void UI::keyPressDone(unsigned int key, bool held)
 {
@@ -721,7 +945,35 @@ void UI::keyPressDone(unsigned int key, bool held)
   }
 }
 
-/* Exec mode key press handler. */
+/* Tune mode key press handler. Left abandons a tune that is still going.
+ * Once it has finished, select saves the gains and left drops them; after
+ * a failed tune any key leaves. */
+void UI::keyPressTune(unsigned int key, bool held)
+{
+  if (_tuning && (key != KEY_LEFT))
+  {
+    return;
+  }
+
+  if (_tuneSave)
+  {
+    if (key == KEY_SELECT)
+    {
+      saveTune();
+    }
+    else if (key != KEY_LEFT)
+    {
+      return;
+    }
+
+    _tuneSave = false;
+  }
+
+  setState(STATE_MENU);
+}
+
+/* Exec mode key press handler. Left goes back to the menu leaving the
+ * function running, so another can be started alongside it. */
 void UI::keyPressExec(unsigned int key, bool held)
 {
   switch (key)
@@ -729,13 +981,18 @@ void UI::keyPressExec(unsigned int key, bool held)
     case KEY_RIGHT:
     case KEY_UP:
     case KEY_DOWN:
-    case KEY_LEFT:
     case KEY_SELECT:
     {
       setState(STATE_TIME);
       break;
     }
 
+    case KEY_LEFT:
+    {
+      setState(STATE_MENU);
+      break;
+    }
+
     default:
       // do nothing
       break;
@@ -750,6 +1007,13 @@ void UI::keyPressMenu(unsigned int key, bool held)
     case KEY_RIGHT:
     case KEY_SELECT:
     {
+      /* Go back to a function that is already running. */
+      if ((_menuPosition < UI_MAX_FUNCS) && _running[_menuPosition])
+      {
+        resumeFunction(_menuPosition);
+        break;
+      }
+
       switch (_menuPosition)
       {
         case UI_FUNC_MASH:
@@ -787,6 +1051,35 @@ void UI::keyPressMenu(unsigned int key, bool held)
           break;
         }
 
+        /* A vessel can't be tuned while a function is using it. */
+        case UI_MENU_TUNE_RIMS:
+        {
+          if (getRunning(PROBE_RIMS) >= 0)
+          {
+            _beeper.pulse(BEEP_TIME, BEEP_TIME, 2);
+            break;
+          }
+
+          _tuneVessel = VESSEL_RIMS;
+          setState(STATE_TUNE);
+
+          break;
+        }
+
+        case UI_MENU_TUNE_BK:
+        {
+          if (getRunning(PROBE_BK) >= 0)
+          {
+            _beeper.pulse(BEEP_TIME, BEEP_TIME, 2);
+            break;
+          }
+
+          _tuneVessel = VESSEL_BK;
+          setState(STATE_TUNE);
+
+          break;
+        }
+
         default:
           break;
       }
@@ -807,7 +1100,7 @@ void UI::keyPressMenu(unsigned int key, bool held)
 
     case KEY_DOWN:
     {
-      if (_menuPosition < (UI_MAX_FUNCS - 1))
+      if (_menuPosition < (UI_MENU_ITEMS - 1))
       {
         _menuPosition++;
         _display.printMenu(_name, _menuPosition);
@@ -835,12 +1128,12 @@ void UI::keyPressTemp(unsigned int key, bool held)
         if (held)
         {
           /* Prevent it from blinking. */
-          _nextTickBlink += 500;
+          _brewBot->scheduler.postpone(_taskBlink, 500);
 
           /* Set the new temperature. */
-          if (getTargetTemp() < UI_TEMP_MAX - 10)
+          if (getTargetTemp() < UI_TEMP_MAX - UI_TEMP_JUMP)
           {
-            setTargetTemp(getTargetTemp() + 10);
+            setTargetTemp(getTargetTemp() + UI_TEMP_JUMP);
           }
           else
           {
@@ -849,7 +1142,7 @@ void UI::keyPressTemp(unsigned int key, bool held)
         }
         else
         {
-          setTargetTemp(getTargetTemp() + 0.5);
+          setTargetTemp(getTargetTemp() + UI_TEMP_STEP);
         }
 
         _display.printTargetTemp(getTargetTemp());
@@ -866,12 +1159,12 @@ void UI::keyPressTemp(unsigned int key, bool held)
         if (held)
         {
           /* Prevent it from blinking. */
-          _nextTickBlink += 500;
+          _brewBot->scheduler.postpone(_taskBlink, 500);
 
           /* Set the new temperature. */
-          if (getTargetTemp() > (UI_TEMP_MIN + 10))
+          if (getTargetTemp() > (UI_TEMP_MIN + UI_TEMP_JUMP))
           {
-            setTargetTemp(getTargetTemp() - 10);
+            setTargetTemp(getTargetTemp() - UI_TEMP_JUMP);
           }
           else
           {
@@ -880,7 +1173,7 @@ void UI::keyPressTemp(unsigned int key, bool held)
         }
         else
         {
-          setTargetTemp(getTargetTemp() - 0.5);
+          setTargetTemp(getTargetTemp() - UI_TEMP_STEP);
         }
 
         _display.printTargetTemp(getTargetTemp());
@@ -892,7 +1185,7 @@ void UI::keyPressTemp(unsigned int key, bool held)
     /* Move to the next step. */
     case KEY_RIGHT:
     {
-      if (_step < (_numSteps - 1))
+      if (_step[_function] < (_numSteps[_function] - 1))
       {
         setState(STATE_NEXT);
       }
@@ -910,7 +1203,7 @@ void UI::keyPressTemp(unsigned int key, bool held)
     /* Start program. */
     case KEY_SELECT:
     {
-      if (_time[_step] != 0)
+      if ((getTime() != 0) && canStart())
       {
         setState(STATE_EXEC);
       }
@@ -936,7 +1229,7 @@ void UI::keyPressTime(unsigned int key, bool held)
         if (held)
         {
           /* Prevent it from blinking. */
-          _nextTickBlink += 500;
+          _brewBot->scheduler.postpone(_taskBlink, 500);
 
           /* Set the new time. */
           if (getTime() < UI_TIME_MAX - 10)
@@ -967,7 +1260,7 @@ void UI::keyPressTime(unsigned int key, bool held)
         if (held)
         {
           /* Prevent it from blinking. */
-          _nextTickBlink += 500;
+          _brewBot->scheduler.postpone(_taskBlink, 500);
 
           /* Set the new time. */
           if (getTime() > (UI_TIME_MIN + 10)) {
@@ -993,7 +1286,7 @@ void UI::keyPressTime(unsigned int key, bool held)
     /* Start program. */
     case KEY_SELECT:
     {
-      if (getTime() != 0)
+      if ((getTime() != 0) && canStart())
       {
         setState(STATE_EXEC);
       }
@@ -1003,7 +1296,7 @@ void UI::keyPressTime(unsigned int key, bool held)
     /* Move focus to the timer. */
     case KEY_LEFT:
     {
-      if (_step != 0)
+      if (_step[_function] != 0)
       {
         setState(STATE_PREV);
       }
@@ -1069,31 +1362,32 @@ void UI::handleButtons(void *ptr, int id, bool held)
       break;
     }
 
+    case STATE_TUNE:
+    {
+      ui->keyPressTune(id, held);
+
+      break;
+    }
+
     default:
       // Do nothing
       break;
   }
 }
 
+/* Blink the menu item. */
 void UI::displayBlinkMenuItem()
 {
-  static bool blink = true;
-  unsigned long now = millis();
-
-  if (now >= _nextTickBlink)
+  if (_blink)
   {
-    if (blink)
-    {
-      _display.clearMenuItem();
-    }
-    else
-    {
-      _display.printMenu((char **)_name, _menuPosition);
-    }
-
-    blink = !blink;
-    _nextTickBlink = now + BLINK_TIME;
+    _display.clearMenuItem();
   }
+  else
+  {
+    _display.printMenu((char **)_name, _menuPosition);
+  }
+
+  _blink = !_blink;
 }
 
 
@@ -1107,6 +1401,8 @@ void UI::setFunction(unsigned int function)
   setName(function);
 
   _function = function;
+
+  applyStep(_function);
 }
 
 inline void UI::setName(unsigned int function)
@@ -1117,10 +1413,14 @@ inline void UI::setName(unsigned int function)
   }
 }
 
-void UI::setProbeDev(OneWireTemperatureDevice *devProbe)
+void UI::setProbe(unsigned int probe)
 {
-  _devProbe = devProbe;
-  _probeTemp = _devProbe->Read();
+  /* Only the probe on display needs reading for it. */
+  _brewBot->unsubscribeProbe(_probe, PROBE_USER_UI);
+  _brewBot->subscribeProbe(probe, PROBE_USER_UI);
+
+  _probe = probe;
+  _probeTemp = _brewBot->getProbeTemp(_probe);
 }
 
 void UI::setNumSteps(unsigned int numSteps)
@@ -1130,55 +1430,159 @@ void UI::setNumSteps(unsigned int numSteps)
     numSteps = UI_MAX_STEPS;
   }
 
-  _numSteps = numSteps;
+  _numSteps[_function] = numSteps;
 }
 
-void UI::setTargetTemp(double temp)
+void UI::setTargetTemp(int temp)
 {
   if (temp > UI_TEMP_MAX)
   {
     temp = UI_TEMP_MAX;
   }
 
-  /* Update PID set point. */
-  double normalised = temp / (UI_TEMP_MAX - UI_TEMP_MIN);
-  double setPoint = normalised * PID_MAX;
+  _targetTemp[_function][_step[_function]] = temp;
 
-  switch (_function)
+  applyStep(_function);
+}
+
+/* Vessel a function heats, or VESSEL_NONE. */
+int UI::getVessel(unsigned int function)
+{
+  switch (function)
   {
     case UI_FUNC_MASH:
     case UI_FUNC_SPARGE:
-    {
-      _brewBot->devPIDRIMS.Write(setPoint);
-      break;
-    }
+      return VESSEL_RIMS;
 
     case UI_FUNC_BOIL:
     case UI_FUNC_DISINF:
-    {
-      _brewBot->devPIDBK.Write(setPoint);
-      break;
-    }
+      return VESSEL_BK;
 
     default:
-      break;
+      return VESSEL_NONE;
+  }
+}
+
+/* Probe a function reads. COOL watches the kettle. */
+unsigned int UI::getProbe(unsigned int function)
+{
+  return (getVessel(function) == VESSEL_RIMS) ? PROBE_RIMS : PROBE_BK;
+}
+
+/* Give the PID the function's current set point, and the gains for this
+ * function in that temperature band. The set point uses the same 1/16C
+ * units. Only a running function drives its vessel's PID, so editing one
+ * leaves whatever else is running alone, and a preheating one has already
+ * moved on to the next step's target. */
+void UI::applyStep(unsigned int function)
+{
+  int vessel = getVessel(function);
+
+  if ((vessel == VESSEL_NONE) || !_running[function] ||
+      _preheating[function])
+  {
+    return;
+  }
+
+  Pid *pid = (vessel == VESSEL_RIMS) ? &_brewBot->pidRIMS : &_brewBot->pidBK;
+  int temp = _targetTemp[function][_step[function]];
+
+  pid->setSetpoint(temp);
+  _brewBot->scheduleGains(vessel, function, temp);
+}
+
+/* Move the PID on to the next step's target early, so that it is PREHEAT
+ * percent of the way there when this step's timer runs out. The heat-up
+ * time comes from how fast the vessel has been seen to rise, or the ramp if
+ * that is slower. */
+void UI::preheat(unsigned int function)
+{
+  int vessel = getVessel(function);
+  unsigned int step = _step[function];
+  unsigned int next = step + 1;
+
+  if (_preheating[function] || (PREHEAT == 0) || (vessel == VESSEL_NONE) ||
+      (next >= _numSteps[function]) || (_time[function][next] == 0) ||
+      (_targetTemp[function][next] <= _targetTemp[function][step]))
+  {
+    return;
+  }
+
+  Pid *pid = (vessel == VESSEL_RIMS) ? &_brewBot->pidRIMS : &_brewBot->pidBK;
+  double rate = pid->getRiseRate();
+
+  if ((pid->getRamp() > 0.00) && ((rate <= 0.00) || (pid->getRamp() < rate)))
+  {
+    rate = pid->getRamp();
+  }
+
+  if (rate <= 0.00)
+  {
+    return;
+  }
+
+  /* In timer minutes, as the time left is. */
+  double minutes = (_targetTemp[function][next] -
+                    _targetTemp[function][step]) *
+                   (PREHEAT / 100.00) / (rate * (TIMER_TIME / 1000.00));
+
+  if (_time[function][step] <= minutes)
+  {
+    pid->setSetpoint(_targetTemp[function][next]);
+    _brewBot->scheduleGains(vessel, function, _targetTemp[function][next]);
+    _preheating[function] = true;
   }
+}
+
+/* Whether the step's timer should be running. Once preheating the step is
+ * left to finish, since the vessel is meant to be leaving its band. A boil
+ * or disinfection only has to be hot enough, so its timer also runs
+ * however far past the target the kettle gets. */
+bool UI::isHeld(unsigned int function)
+{
+  if ((UI_HOLD_BAND == 0) || _preheating[function] ||
+      (getVessel(function) == VESSEL_NONE))
+  {
+    return true;
+  }
+
+  int temp = _brewBot->getProbeTemp(getProbe(function));
+  int target = _targetTemp[function][_step[function]];
+
+  if ((function == UI_FUNC_BOIL) || (function == UI_FUNC_DISINF))
+  {
+    return (temp >= (target - UI_HOLD_BAND));
+  }
+
+  return (abs(temp - target) <= UI_HOLD_BAND);
+}
 
-  _targetTemp[_function][_step] = temp;
+/* Record how long the step took to get into band, and how long it was held
+ * there. */
+void UI::logStep(unsigned int function)
+{
+  unsigned int step = _step[function];
+
+  _brewBot->eventLog.log(EVENT_STEP_DONE, (function << 8) | step);
+  _brewBot->eventLog.log(EVENT_STEP_RAMP, _rampTime[function][step]);
+  _brewBot->eventLog.log(EVENT_STEP_HOLD, _holdTime[function][step]);
 }
 
-inline bool UI::nextStep()
+inline bool UI::nextStep(unsigned int function)
 {
-  setStep(_step + 1);
-  return (_time[_function][_step] != 0);
+  setStep(function, _step[function] + 1);
+  return (_time[function][_step[function]] != 0);
 }
 
-inline bool UI::setStep(unsigned int step)
+inline bool UI::setStep(unsigned int function, unsigned int step)
 {
   /* Check if this is a valid step. */
-  if (step < _numSteps)
+  if (step < _numSteps[function])
   {
-    _step = step;
+    _step[function] = step;
+    _preheating[function] = false;
+    _ramping[function] = false;
+    applyStep(function);
 
     return true;
   }
@@ -1188,7 +1592,7 @@ inline bool UI::setStep(unsigned int step)
 
 inline void UI::setTime(double time)
 {
-  _time[_function][_step] = time;
+  _time[_function][_step[_function]] = time;
 }
 
 UI::states UI::getState(void)
@@ -1200,97 +1604,56 @@ UI::states UI::getState(void)
 void UI::display(void)
 {
   _display.printFunction(getName(), getTargetTemp(), getProbeTemp(), getTime(), false);
-}
 
-void UI::displayBlink(void (*clear)(void), void (*print)(void))
-{
-  static bool blink = true;
-  unsigned long now = millis();
-
-  /* Is it time to blink? */
-  if (now >= _nextTickBlink)
+  if (_running[_function] && _ramping[_function])
   {
-    if (blink)
-    {
-      clear();
-    }
-    else
-    {
-      print();
-    }
-
-    blink = !blink;
-    _nextTickBlink = now + BLINK_TIME;
+    displayPhase();
   }
 }
 
 /* Blink the time. */
 void UI::displayBlinkTime()
 {
-  static bool blink = true;
-  unsigned long now = millis();
-
-  /* Is it time to blink? */
-  if (now >= _nextTickBlink)
+  if (_blink)
   {
-    if (blink)
-    {
-      _display.clearTime();
-    }
-    else
-    {
-      _display.printTime(getTime());
-    }
-
-    blink = !blink;
-    _nextTickBlink = now + BLINK_TIME;
+    _display.clearTime();
+  }
+  else
+  {
+    _display.printTime(getTime());
   }
+
+  _blink = !_blink;
 }
 
 /* Blink the target temperature. */
 void UI::displayBlinkTemp()
 {
-  static bool blink = true;
-  unsigned long now = millis();
-
-  /* Is it time to blink? */
-  if (now >= _nextTickBlink)
+  if (_blink)
   {
-    if (blink)
-    {
-      _display.clearTargetTemp();
-    }
-    else
-    {
-      _display.printTargetTemp(getTargetTemp());
-    }
-
-    blink = !blink;
-    _nextTickBlink = now + BLINK_TIME;
+    _display.clearTargetTemp();
   }
+  else
+  {
+    _display.printTargetTemp(getTargetTemp());
+  }
+
+  _blink = !_blink;
 }
 
 /* Blink ":" in the time. */
 void UI::displayBlinkIndicator()
 {
-  static bool blink = true;
-  unsigned long now = millis();
-
-  /* Is it time to blink? */
-  if (now >= _nextTickBlink)
+  if (_blink)
   {
-    if (blink)
-    {
-      _display.clearIndicator();
-    }
-    else
-    {
-      _display.printIndicator();
-    }
-
-    blink = !blink;
-    _nextTickBlink = now + BLINK_TIME;
+    _display.clearIndicator();
+  }
+  else
+  {
+    _display.printIndicator();
   }
+
+  _blink = !_blink;
 }
 
 /* Display the probe temperature. */
@@ -1302,22 +1665,58 @@ void UI::displayProbeTemp()
   }
 }
 
-/* Display the timer. */
-void UI::displayTimer()
+/* Display the time spent ramping while out of band, otherwise the time left
+ * in the step. */
+void UI::displayPhase()
 {
-  if (updateTimer())
+  unsigned int step = _step[_function];
+
+  if (_ramping[_function])
   {
-    _display.printTime(_time[_function][_step]);
+    _display.printRamp();
+    _display.printTime(_rampTime[_function][step]);
+  }
+  else
+  {
+    _display.clearRamp();
+    _display.printTime(_time[_function][step]);
+  }
+}
+
+/* Display what is running on each vessel beside the menu, the RIMS on the
+ * top row and the kettle below. */
+void UI::displayStatus()
+{
+  const unsigned int probes[] = { PROBE_RIMS, PROBE_BK };
+
+  for (unsigned int row = 0; row < DISPLAY_ROWS; row++)
+  {
+    int function = getRunning(probes[row]);
+
+    if (function < 0)
+    {
+      _display.clearStatus(row);
+      continue;
+    }
+
+    unsigned int step = _step[function];
+    bool ramp = _ramping[function];
+
+    _display.printStatus(row, _name[function][0],
+                         (_numSteps[function] > 1) ? (step + 1) : 0, ramp,
+                         ramp ? _rampTime[function][step] :
+                                _time[function][step],
+                         _done[function]);
   }
 }
 
 char *UI::getName()
 {
-  if (_numSteps > 1)
+  if (_numSteps[_function] > 1)
   {
     unsigned int i = (UI_NAME_LEN - 1);
     _nameDisplay[i++] = ' ';
-    itoa(_step + 1, &_nameDisplay[i++], 10);
+    itoa(_step[_function] + 1, &_nameDisplay[i++], 10);
     _nameDisplay[i++] = '\0';
   }
   else
@@ -1333,15 +1732,15 @@ char *UI::getName()
 
 inline unsigned long UI::getTime()
 {
-  return _time[_function][_step];
+  return _time[_function][_step[_function]];
 }
 
-inline double UI::getTargetTemp()
+inline int UI::getTargetTemp()
 {
-  return _targetTemp[_function][_step];
+  return _targetTemp[_function][_step[_function]];
 }
 
-inline double UI::getProbeTemp()
+inline int UI::getProbeTemp()
 {
   return _probeTemp;
 }
@@ -1351,72 +1750,125 @@ bool UI::updateProbeTemp()
   bool updated = false;
 
   /* Read temperature. */
-  if (_devProbe->report_status)
+  int temp = _brewBot->getProbeTemp(_probe);
+  if (temp != _probeTemp)
   {
-    _probeTemp = _devProbe->Read();
-    _devProbe->report_status = false;
+    _probeTemp = temp;
     updated = true;
   }
 
   return updated;
 }
 
-bool UI::updateTimer()
+bool UI::updateTimer(unsigned int function)
 {
-  unsigned long now = millis();
   bool updated = false;
+  unsigned int step = _step[function];
 
-  if (now >= _nextTickTimer)
+  /* Out of band, the step waits and the time goes to the ramp. */
+  if (_ramping[function])
   {
-    /* Tick timer down. */
-    if (_time[_function][_step] > 0)
+    if (_rampTime[function][step] < UI_TIME_MAX)
     {
-      _time[_function][_step]--;
+      _rampTime[function][step]++;
       updated = true;
     }
 
-    /* Set next tick. */
-    _nextTickTimer = now + TIMER_TIME;
+    return updated;
+  }
+
+  /* Tick timer down. */
+  if (_time[function][step] > 0)
+  {
+    _time[function][step]--;
+    _holdTime[function][step]++;
+    updated = true;
   }
 
   return updated;
 }
 
-bool UI::updateReminder()
+/* Tick every running function's timer, showing the one on display. */
+void UI::updateTimers()
 {
-  unsigned long now = millis();
-  bool updated = false;
-
-  if (now >= _nextTickReminder)
+  for (unsigned int function = 0; function < UI_MAX_FUNCS; function++)
   {
-    /* Beep. */
-    _numBeeps = 2;
-
-    /* Set next tick. */
-    _nextTickReminder = now + REMINDER_TIME;
+    if (!_running[function] || _done[function])
+    {
+      continue;
+    }
 
-    updated = true;
+    if (updateTimer(function) && (function == _function) &&
+        (_state == STATE_EXEC))
+    {
+      displayPhase();
+    }
   }
-
-  return updated;
 }
 
-bool UI::updateBeeper()
+void UI::updateReminder()
 {
-  static bool beep = false;
-  unsigned long now = millis();
-  bool updated = false;
+  /* Beep. */
+  _beeper.pulse(BEEP_TIME, BEEP_TIME, 1);
+}
 
-  if (now >= _nextTickBeeper)
+/* Blink whichever field has focus. */
+void UI::tickBlink(void *cookie)
+{
+  UI *ui = (UI *)(cookie);
+  switch (ui->getState())
   {
-    /* Toggle beeper. */
-    beep = !beep;
-    _brewBot->devBeeper.Write(beep);
+    case STATE_MENU:
+    {
+      ui->displayBlinkMenuItem();
+      break;
+    }
+
+    case STATE_TIME:
+    {
+      ui->displayBlinkTime();
+      break;
+    }
 
-    _nextTickBeeper = now + BEEP_TIME;
+    case STATE_TEMP:
+    {
+      ui->displayBlinkTemp();
+      break;
+    }
 
-    updated = true;
+    case STATE_EXEC:
+    {
+      ui->displayBlinkIndicator();
+      break;
+    }
+
+    default:
+      break;
   }
+}
 
-  return updated;
+void UI::tickTimer(void *cookie)
+{
+  ((UI *)(cookie))->updateTimers();
+}
+
+void UI::tickReminder(void *cookie)
+{
+  ((UI *)(cookie))->updateReminder();
+}
+
+void UI::tickState(void *cookie)
+{
+  UI *ui = (UI *)(cookie);
+  ui->setState(ui->_nextState);
+}
+
+/* Show the next step once the finished one has been seen. */
+void UI::tickDisplay(void *cookie)
+{
+  UI *ui = (UI *)(cookie);
+  if (ui->getState() == STATE_EXEC)
+  {
+    ui->display();
+  }
 }
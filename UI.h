@@ -27,14 +27,13 @@
 
 #include <DallasTemperature.h>
 #include <BooleanDevice.h>
-#include <OneWireTemperatureDevice.h>
-#include <PidRelayDevice.h>
 
 #include "constants.h"
 #include "pins.h"
 #include "BrewBot.h"
 #include "Buttons.h"
 #include "Display.h"
+#include "PatternPlayer.h"
 
 #define UI_NAME_LEN        7
 #define UI_NAME_DISP_LEN   9
@@ -48,6 +47,15 @@
 #define UI_FUNC_DISINF  3
 #define UI_FUNC_COOL    4
 
+#if UI_MAX_FUNCS > GAINS_FUNCTIONS
+  #error "Every function needs a slot of PID gains"
+#endif
+
+/* Menu entries after the functions. */
+#define UI_MENU_TUNE_RIMS  5
+#define UI_MENU_TUNE_BK    6
+#define UI_MENU_ITEMS      7
+
 #define UI_TIME_MAX      599UL // 9h59m
 #define UI_TIME_MIN        0UL // 0h00m
 #define UI_TIME_DEFAULT    0UL // 0h30m
@@ -55,15 +63,27 @@
 #define UI_TIME_DISINF    15UL // 0h15m
 #define UI_TIME_COOL     599UL // 9h59m
 
-#define UI_TEMP_MAX      120.00F // 120C
-#define UI_TEMP_MIN        0.00F // 0C
-#define UI_TEMP_DEFAULT   60.00F // 65C
+#define UI_TEMP_MAX      (120 * TEMP_ONE) // 120C
+#define UI_TEMP_MIN        (0 * TEMP_ONE) // 0C
+#define UI_TEMP_DEFAULT   (60 * TEMP_ONE) // 65C
+#define UI_TEMP_STEP       (TEMP_ONE / 2) // 0.5C
+#define UI_TEMP_JUMP      (10 * TEMP_ONE) // 10C
+
+/* How far either side of the target a step's timer runs (hold mode). Time
+ * spent further out is counted as the ramp. 0 runs the timer regardless. */
+#define UI_HOLD_BAND      (TEMP_ONE) // 1C
+
+#define UI_TUNE_TEMP      (65 * TEMP_ONE) // 65C, autotune set point
+
+#define UI_STARTUP_TIME  2000 // Time to show the start-up message
+#define UI_PAUSE_TIME     500 // Time to show a function before editing it
 
 class UI
 {
   public:
     enum states
     {
+      STATE_INIT,
       STATE_MENU,
       STATE_MASH,
       STATE_SPARGE,
@@ -76,6 +96,7 @@ class UI
       STATE_PREV,
       STATE_EXEC,
       STATE_DONE,
+      STATE_TUNE,
     };
 
     UI(BrewBot *brewBot);
@@ -86,14 +107,20 @@ class UI
     void display(void);
 
     void setFunction(unsigned int function);
-    void setProbeDev(OneWireTemperatureDevice *devProbe);
+    void setProbe(unsigned int probe);
     void setNumSteps(unsigned int numSteps);
 
     void setState(states state);
+    void setStateLater(states state, unsigned long delay);
     states getState(void);
 
   private:
     static void handleButtons(void *cookie, int id, bool held);
+    static void tickBlink(void *cookie);
+    static void tickTimer(void *cookie);
+    static void tickReminder(void *cookie);
+    static void tickState(void *cookie);
+    static void tickDisplay(void *cookie);
 
     void displayBlinkMenuItem(void);
 
@@ -103,60 +130,102 @@ class UI
     Buttons _buttons;
     unsigned int _function;
     states _state;
+    states _nextState;
+
+    PatternPlayer _beeper;
+    PatternPlayer _indicator;
 
 //    char _name[UI_MAX_FUNCS][UI_NAME_LEN];
-    char *_name[UI_MAX_FUNCS + 1];
+    char *_name[UI_MENU_ITEMS + 1];
     char _nameDisplay[UI_NAME_DISP_LEN];
 
-    OneWireTemperatureDevice *_devProbe;
+    /* Probe on display. */
+    unsigned int _probe;
 
-    unsigned int _numSteps;
-    unsigned int _step;
+    /* Each function keeps its own place, so several can run at once. */
+    unsigned int _numSteps[UI_MAX_FUNCS];
+    unsigned int _step[UI_MAX_FUNCS];
+    bool _running[UI_MAX_FUNCS];
+    bool _done[UI_MAX_FUNCS];
+    bool _preheating[UI_MAX_FUNCS];
+    bool _ramping[UI_MAX_FUNCS];
 
-    unsigned long _nextTickBlink;
-    unsigned long _nextTickTimer;
-    unsigned long _nextTickReminder;
-    unsigned long _nextTickBeeper;
+    int _taskBlink;
+    int _taskTimer;
+    int _taskReminder;
+    int _taskState;
+    int _taskDisplay;
 
-    unsigned int _numBeeps;
+    bool _blink;
 
     unsigned long _time[UI_MAX_FUNCS][UI_MAX_STEPS];
-    double _targetTemp[UI_MAX_FUNCS][UI_MAX_STEPS];
-    double _probeTemp;
+    int _targetTemp[UI_MAX_FUNCS][UI_MAX_STEPS];
+    unsigned long _rampTime[UI_MAX_FUNCS][UI_MAX_STEPS];
+    unsigned long _holdTime[UI_MAX_FUNCS][UI_MAX_STEPS];
+    int _probeTemp;
 
     int _menuPosition;
 
     void startFunction(void);
     void stopFunction(void);
-
-    bool nextStep(void);
-    bool setStep(unsigned int step);
+    void resumeFunction(unsigned int function);
+    void runFunction(unsigned int function);
+    bool canStart(void);
+    void updateOutputs(void);
+
+    int getRunning(unsigned int probe);
+    bool anyRunning(void);
+    bool anyDone(void);
+
+    void startTune(void);
+    void stopTune(void);
+    void finishTune(void);
+    void saveTune(void);
+
+    int _tuneVessel;
+    bool _tuning;
+    unsigned long _tuneMinutes;
+
+    /* Gains from a finished tune, until they are saved or not. */
+    bool _tuneSave;
+    BrewBot::gains _tuneGains;
+
+    static int getVessel(unsigned int function);
+    static unsigned int getProbe(unsigned int function);
+    void applyStep(unsigned int function);
+    void preheat(unsigned int function);
+    bool isHeld(unsigned int function);
+    void logStep(unsigned int function);
+
+    bool nextStep(unsigned int function);
+    bool setStep(unsigned int function, unsigned int step);
     void setName(unsigned int function);
     void setTime(double time);
-    void setTargetTemp(double temp);
+    void setTargetTemp(int temp);
 
     char *getName();
     unsigned long getTime();
-    double getTargetTemp();
-    double getProbeTemp();
+    int getTargetTemp();
+    int getProbeTemp();
 
     bool updateProbeTemp();
-    bool updateTimer();
-    bool updateReminder();
-    bool updateBeeper();
+    bool updateTimer(unsigned int function);
+    void updateTimers();
+    void updateReminder();
 
-    void displayBlink(void (*clear)(void), void (*print)(void));
     void displayBlinkTime();
     void displayBlinkTemp();
     void displayBlinkIndicator();
     void displayProbeTemp();
-    void displayTimer();
+    void displayPhase();
+    void displayStatus();
 
     void keyPressMenu(unsigned int key, bool held);
     void keyPressTime(unsigned int key, bool held);
     void keyPressTemp(unsigned int key, bool held);
     void keyPressExec(unsigned int key, bool held);
     void keyPressDone(unsigned int key, bool held);
+    void keyPressTune(unsigned int key, bool held);
 };
 
 #endif
@@ -0,0 +1,98 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include "ZeroCross.h"
+
+volatile uint8_t ZeroCross::_edges = 0;
+
+/* hz: mains frequency, for timing half-cycles without a detector. */
+ZeroCross::ZeroCross(uint8_t pin, unsigned int hz)
+: _pin(pin), _halfCycle(1000000UL / (hz * 2)), _lastEdges(0),
+  _lastEdgeTime(0), _lastStep(0), _detected(false)
+{
+}
+
+void ZeroCross::setup(void)
+{
+  pinMode(_pin, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(_pin), edge, RISING);
+
+  _lastEdgeTime = millis();
+  _lastStep = micros();
+}
+
+/* Number of half-cycles since the last poll. A single byte is read from
+ * the interrupt, so no locking is needed as long as this is polled at least
+ * every 256 half-cycles. */
+uint8_t ZeroCross::poll(void)
+{
+  uint8_t edges = _edges;
+  uint8_t count = edges - _lastEdges;
+
+  if (count != 0)
+  {
+    _lastEdges = edges;
+    _lastEdgeTime = millis();
+    _lastStep = micros();
+    _detected = true;
+
+    return count;
+  }
+
+  if (_detected && ((millis() - _lastEdgeTime) < ZERO_CROSS_TIMEOUT))
+  {
+    return 0;
+  }
+
+  /* No detector, so go by the clock. */
+  _detected = false;
+
+  unsigned long elapsed = micros() - _lastStep;
+  if (elapsed < _halfCycle)
+  {
+    return 0;
+  }
+
+  /* Don't try to catch up on a long stall. */
+  if ((elapsed / _halfCycle) > 255)
+  {
+    _lastStep = micros();
+    return 255;
+  }
+
+  count = elapsed / _halfCycle;
+  _lastStep += count * _halfCycle;
+
+  return count;
+}
+
+bool ZeroCross::isDetected(void)
+{
+  return _detected;
+}
+
+void ZeroCross::edge(void)
+{
+  _edges++;
+}
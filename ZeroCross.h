@@ -0,0 +1,58 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ZERO_CROSS_H
+#define ZERO_CROSS_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+/* Time without an edge before the detector counts as missing. */
+#define ZERO_CROSS_TIMEOUT  100 // ms
+
+/* Counts AC half-cycles. Each zero crossing raises an edge on an external
+ * interrupt pin, which the interrupt just counts. With no detector fitted
+ * (or if it stops) the half-cycles are timed from micros() instead. */
+class ZeroCross
+{
+  public:
+    ZeroCross(uint8_t pin, unsigned int hz);
+
+    void setup(void);
+
+    uint8_t poll(void);
+    bool isDetected(void);
+
+  private:
+    static void edge(void);
+
+    static volatile uint8_t _edges;
+
+    uint8_t _pin;
+    unsigned long _halfCycle;
+
+    uint8_t _lastEdges;
+    unsigned long _lastEdgeTime;
+    unsigned long _lastStep;
+    bool _detected;
+};
+
+#endif
@@ -19,18 +19,125 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
+/* Probe resolution at power up, and while a probe has no target. */
 #define TEMPERATURE_PRECISION  (9)
 
+/* Probes with a target get finer, slower readings the closer they are to
+ * it (1/16C). */
+#define RESOLUTION_FAR    (5 * TEMP_ONE)  // 9 bits beyond this
+#define RESOLUTION_NEAR   (2 * TEMP_ONE)  // 10 bits beyond this
+#define RESOLUTION_CLOSE  (TEMP_ONE / 2)  // 11 bits beyond this, else 12
+
+/* Which display is fitted. */
+#define DISPLAY_PARALLEL  0
+#define DISPLAY_I2C       1
+#define DISPLAY_TERMINAL  2 // ANSI terminal on the serial port, no event log
+
+#ifndef DISPLAY_BACKEND
+#define DISPLAY_BACKEND  DISPLAY_PARALLEL
+#endif
+
+/* How the relay shift register is driven. */
+#define RELAY_BITBANG  0
+#define RELAY_SPI      1 // Hardware SPI, see pins.h
+
+#ifndef RELAY_MODE
+#define RELAY_MODE  RELAY_BITBANG
+#endif
+
+/* Frames sent to time one, see the 'b' serial command. */
+#define RELAY_TIME_COUNT  (256)
+
 #define SENSOR_TIME    (1000)
 #define BLINK_TIME     (500)
 #define BEEP_TIME      (500)
+#ifndef TIMER_TIME
 #define TIMER_TIME     (1000) // (1000*60) // 1 minute
+#endif
 #define REMINDER_TIME  (1000*10) // 10 seconds
 
+/* Longest serial command line, see handleSerial(). */
+#define SERIAL_LINE_SIZE  (48)
+
+/* Period the devices are serviced at, in us. */
+#define CONTROL_TIME  (10000UL)
+
+/* Period the PIDs are computed at. */
+#define PID_TIME  (1000)
+
+/* Passes run to time one, see the 'f' serial command. */
+#define PID_TIME_COUNT  (64)
+
+/* PID gains, for temperatures in 1/16C and a demand of 0 to 1. */
+#define PID_RIMS_KP  (0.05)
+#define PID_RIMS_KI  (0.0005)
+#define PID_RIMS_KD  (0.00)
+#define PID_BK_KP    (0.05)
+#define PID_BK_KI    (0.0005)
+#define PID_BK_KD    (0.00)
+
+/* Most the set point rises per timer minute between steps (1/16C), or 0 to
+ * jump straight to the next step's target. */
+#define RAMP_RIMS  (0)
+#define RAMP_BK    (0)
+
+/* How much of the heat-up to the next step to start before the current one
+ * ends, as a percentage. 100 reaches the next step as its timer starts, 0
+ * waits for the timer to run out first. A step that is preheating is let
+ * run out of band, so anything but 0 gives up some of the time held within
+ * UI_HOLD_BAND for a shorter brew day. */
+#define PREHEAT  (0)
+
+/* How far past the set point the autotuner's relay switches (1/16C). */
+#define AUTOTUNE_HYSTERESIS  (TEMP_ONE / 4)
+
+/* How the PID demand is turned into element on-times, see Modulator.h. */
+#define ELEMENT_MODULATION  MODULATOR_BURST
+#define ELEMENT_WINDOW      (360) // half-cycles, MODULATOR_WINDOW only
+#define ELEMENT_STEPS       (60)  // MODULATOR_WINDOW only
+
+/* Mains frequency, for timing half-cycles with no zero-cross detector. */
+#define MAINS_HZ  (60)
+
+/* Element ratings, and the most the circuit can carry at once. */
+#define ELEMENT_RIMS_POWER  (1500.00) // W
+#define ELEMENT_BK_POWER    (5500.00) // W
+#define POWER_LIMIT         (5760.00) // W, 24A at 240V
+
 #define ELEMENT_CONTROL_RIMS  (false)
 #define ELEMENT_CONTROL_BK    (true)
 
-#define PID_MAX  (1024.00)
+/* Temperatures are fixed point in the DS18B20's native 1/16C, from the
+ * probes to the PID inputs and set points and out to the display. The PID
+ * arithmetic itself is still double. */
+#define TEMP_SHIFT  4
+#define TEMP_ONE    (1 << TEMP_SHIFT)
+
+/* DallasTemperature's raw readings are 1/128C. */
+#define TEMP_RAW_SHIFT  3
+
+/* Replace the probes with a simulated plant, run in real time. To see a
+ * whole brew day quickly, use the host build in tools/host instead. */
+#ifndef SIMULATE_PLANT
+#define SIMULATE_PLANT  0
+#endif
+
+#define PLANT_AMBIENT  (20.00)    // C
+#define PLANT_BOIL     (100.00)   // C
+
+#define PLANT_RIMS_POWER  ELEMENT_RIMS_POWER
+#define PLANT_RIMS_MASS   (25.00 * 4186.00) // 25L of mash (J/C)
+#define PLANT_RIMS_LOSS   (8.00)            // W/C
+#define PLANT_RIMS_DEAD   (30.00)           // Round the mash bed (s)
+
+#define PLANT_BK_POWER    ELEMENT_BK_POWER
+#define PLANT_BK_MASS     (30.00 * 4186.00) // 30L of wort (J/C)
+#define PLANT_BK_LOSS     (12.00)           // W/C
+#define PLANT_BK_DEAD     (10.00)           // Element to probe (s)
+
+/* EEPROM layout. */
+#define EEPROM_PROBES  0  // Probes::save()
+#define EEPROM_GAINS   64 // BrewBot::saveGains(), to 304
 
 #endif
 
@@ -24,6 +24,7 @@
 
 /* Digital pins. */
 #define PIN_ONE_WIRE      2
+#define PIN_ZERO_CROSS    3 // INT1
 #define PIN_LCD_D0        4
 #define PIN_LCD_D1        5
 #define PIN_LCD_D2        6
@@ -37,5 +38,14 @@
 #define PIN_RELAY_CLOCK  18
 #define PIN_RELAY_DATA   19
 
+/* With RELAY_SPI the relay clock and data come from SCK (13) and MOSI (11),
+ * and SS (10) must be an output, so the beeper and debug LED need to move
+ * and the indicator shares SS. Only PIN_RELAY_LATCH is still used. */
+
+/* I2C addresses.
+ * NB: I2C uses A4/A5 (18/19), so the relay clock and data pins need to
+ * move before using DISPLAY_I2C. */
+#define LCD_I2C_ADDRESS  0x27
+
 #endif
 
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/* Just enough of the Arduino core for the sketch to build on a host. Time
+ * comes from a virtual clock, see host.h, so a run goes as fast as the host
+ * can step it and gives the same result every time. */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH  1
+#define LOW   0
+
+#define INPUT         0
+#define OUTPUT        1
+#define INPUT_PULLUP  2
+
+#define LSBFIRST  0
+#define MSBFIRST  1
+
+#define CHANGE   1
+#define FALLING  2
+#define RISING   3
+
+#define DEC  10
+#define HEX  16
+
+/* Uno pins the sketch names. */
+#define SS    10
+#define MOSI  11
+#define SCK   13
+
+#define F_CPU  16000000UL
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder,
+              uint8_t value);
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+#define digitalPinToInterrupt(p)  ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+
+/* One port per pin is plenty when nothing reads them back. */
+extern volatile uint8_t hostPorts[20];
+#define digitalPinToPort(p)     (p)
+#define digitalPinToBitMask(p)  (1)
+#define portOutputRegister(p)   (&hostPorts[(p)])
+
+char *itoa(int value, char *buf, int base);
+char *utoa(unsigned int value, char *buf, int base);
+char *ultoa(unsigned long value, char *buf, int base);
+char *dtostrf(double value, signed char width, unsigned char prec,
+              char *buf);
+char *dtostre(double value, char *buf, unsigned char prec,
+              unsigned char flags);
+
+/* Flash and RAM are the same thing here, so F() strings are plain ones. */
+class __FlashStringHelper;
+#define F(s)  (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t size);
+
+    size_t print(const __FlashStringHelper *s);
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println(const __FlashStringHelper *s);
+    size_t println(const char *s);
+    size_t println(char c);
+    size_t println(unsigned char n, int base = DEC);
+    size_t println(int n, int base = DEC);
+    size_t println(unsigned int n, int base = DEC);
+    size_t println(long n, int base = DEC);
+    size_t println(unsigned long n, int base = DEC);
+    size_t println(double n, int digits = 2);
+    size_t println(void);
+
+  private:
+    size_t printNumber(unsigned long n, int base);
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available(void) = 0;
+    virtual int read(void) = 0;
+};
+
+/* Output goes to host.h's serial hook, input comes from hostSerialInput(). */
+class HardwareSerial : public Stream
+{
+  public:
+    void begin(unsigned long baud);
+    int available(void);
+    int read(void);
+    int availableForWrite(void);
+    size_t write(uint8_t c);
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
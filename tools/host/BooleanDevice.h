@@ -0,0 +1,39 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef BOOLEAN_DEVICE_H
+#define BOOLEAN_DEVICE_H
+
+#include "Arduino.h"
+
+/* An output pin and the value last written to it. The library's third
+ * argument makes no difference here. */
+class BooleanDevice
+{
+  public:
+    BooleanDevice(uint8_t pin, bool value, bool report);
+
+    void Setup(unsigned int id);
+    void Write(bool value);
+    bool Read(void);
+
+  private:
+    uint8_t _pin;
+    bool _value;
+};
+
+#endif
@@ -0,0 +1,61 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef DALLAS_TEMPERATURE_H
+#define DALLAS_TEMPERATURE_H
+
+#include "OneWire.h"
+
+typedef uint8_t DeviceAddress[8];
+
+#define DS18S20MODEL  0x10
+#define DS18B20MODEL  0x28
+
+#define DEVICE_DISCONNECTED_C    (-127)
+#define DEVICE_DISCONNECTED_RAW  (-7040)
+
+/* The library's calls the sketch makes, against the host's probes. A
+ * reading is the probe's temperature at its current resolution, once the
+ * conversion for it is done. */
+class DallasTemperature
+{
+  public:
+    DallasTemperature(OneWire *oneWire);
+
+    void begin(void);
+    uint8_t getDeviceCount(void);
+    bool getAddress(uint8_t *addr, uint8_t index);
+    bool validAddress(const uint8_t *addr);
+    bool validFamily(const uint8_t *addr);
+    bool isConnected(const uint8_t *addr);
+    bool isParasitePowerMode(void);
+
+    bool setResolution(const uint8_t *addr, uint8_t bits,
+                       bool skipGlobalBitResolutionCalculation = false);
+    void setWaitForConversion(bool wait);
+    int16_t millisToWaitForConversion(uint8_t bits);
+
+    void requestTemperatures(void);
+    int16_t getTemp(const uint8_t *addr);
+    float getTempC(const uint8_t *addr);
+
+  private:
+    OneWire *_oneWire;
+    bool _wait;
+};
+
+#endif
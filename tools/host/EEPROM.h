@@ -0,0 +1,36 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stdint.h>
+
+#define HOST_EEPROM_SIZE  1024
+
+/* Starts erased, as a new board's does. */
+class EEPROMClass
+{
+  public:
+    uint8_t read(int addr);
+    void write(int addr, uint8_t value);
+    void update(int addr, uint8_t value);
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
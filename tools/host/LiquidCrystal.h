@@ -0,0 +1,41 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef LIQUID_CRYSTAL_H
+#define LIQUID_CRYSTAL_H
+
+#include "Arduino.h"
+
+#define HOST_LCD_COLS  40
+#define HOST_LCD_ROWS  4
+
+/* Keeps the characters the LCD would show, for hostLcdLine(). Each call
+ * costs the virtual clock what the 4-bit bus and the controller would. */
+class LiquidCrystal : public Print
+{
+  public:
+    LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1,
+                  uint8_t d2, uint8_t d3);
+
+    void begin(uint8_t cols, uint8_t rows);
+    void clear(void);
+    void setCursor(uint8_t col, uint8_t row);
+    size_t write(uint8_t c);
+    using Print::write;
+};
+
+#endif
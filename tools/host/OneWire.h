@@ -0,0 +1,49 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ONE_WIRE_H
+#define ONE_WIRE_H
+
+#include "Arduino.h"
+
+/* A bus of the probes added with hostAddProbe(). Only what the sketch does
+ * is understood: searching, and selecting a probe to write its scratchpad.
+ * Each transaction costs the virtual clock its time on the wire. */
+class OneWire
+{
+  public:
+    OneWire(uint8_t pin);
+
+    uint8_t reset(void);
+    void select(const uint8_t *rom);
+    void skip(void);
+    void write(uint8_t value, uint8_t power = 0);
+
+    void reset_search(void);
+    bool search(uint8_t *rom);
+
+    static uint8_t crc8(const uint8_t *addr, uint8_t len);
+
+  private:
+    int _selected;
+    uint8_t _written;
+    uint8_t _command;
+    uint8_t _scratch[3];
+    int _searchNext;
+};
+
+#endif
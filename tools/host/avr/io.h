@@ -0,0 +1,61 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef AVR_IO_H
+#define AVR_IO_H
+
+#include <stdint.h>
+
+/* The ATmega328P registers the sketch touches. Writing SPDR "sends" the
+ * byte at once and sets SPIF, so a wait on SPSR returns straight away. */
+
+extern volatile uint8_t ADMUX;
+extern volatile uint8_t ADCSRA;
+extern volatile uint8_t ADCSRB;
+extern volatile uint8_t DIDR0;
+extern volatile uint16_t ADC;
+
+#define REFS0  6
+#define ADEN   7
+#define ADATE  5
+#define ADIE   3
+#define ADPS2  2
+#define ADPS1  1
+#define ADPS0  0
+#define ADTS2  2
+
+extern volatile uint8_t SPCR;
+extern volatile uint8_t SPSR;
+
+#define SPE    6
+#define MSTR   4
+#define SPIF   7
+#define SPI2X  0
+
+class hostSPDR
+{
+  public:
+    hostSPDR &operator=(uint8_t value);
+    operator uint8_t() const;
+
+  private:
+    uint8_t _value;
+};
+
+extern hostSPDR SPDR;
+
+#endif
@@ -0,0 +1,662 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/* Runs the sketch itself on a host: BrewBot.ino, UI, Display, Buttons and
+ * the rest are built unchanged against the stand-ins in this directory, on
+ * a virtual clock, so a whole brew day takes seconds. Two DS18B20s on the
+ * bus read the temperature of a simulated RIMS and kettle, heated by
+ * whatever the sketch is switching its elements to. Keys and serial
+ * commands come from a script. Build and run from this directory with:
+ *
+ *   g++ -O2 -std=gnu++11 -fpermissive -w -DARDUINO=100 \
+ *       -DTIMER_TIME=60000UL -I. -I../.. \
+ *       -o brewbot brewbot.cpp host.cpp ../../[A-Z]*.cpp
+ *
+ * with the flags the Arduino builder uses, and the step timer counting
+ * real minutes. The other options in constants.h can be set with -D too.
+ *
+ *   ./brewbot [-m minutes] [-s seconds] [-e] [-l] [-b] [-p] [script]
+ *
+ * -m stops after that many minutes (default when the script ends, or 10),
+ * -s shows the LCD that often, and -e prints the event log records. -l
+ * prints the longest loop() pass for each probe resolution the run used,
+ * and -b has DallasTemperature wait for each conversion, as the sketch did
+ * before it split them into request and collect, to compare with. -p puts
+ * the probes on parasite power. A probe read before its conversion is done
+ * is a failure, as with a failed check. Each script line is a time in
+ * seconds from power-up and one of:
+ *
+ *   keys <key>...   press keys one after another: U, D, L, R or S, with a
+ *                   count to repeat it (U10) or + and seconds to hold it
+ *                   down (U+3)
+ *   serial <text>   send a line to the serial port
+ *   screen          show the LCD
+ *   max <stage> <us>
+ *                   check no pass of a profiler stage has taken longer
+ *                   than that since the last 'r'; brewbot exits with 1 at
+ *                   the end of the run if one did
+ *   end             stop
+ *
+ * A line's time is when it may start; it waits for keys still being
+ * pressed from the lines before it. See mash.txt, and boot.txt,
+ * reset.txt and report.txt for checks.
+ *
+ * Built with -DDISPLAY_BACKEND=DISPLAY_TERMINAL, the screen is read back
+ * from the escape sequences the sketch sends instead, and anything it
+ * prints below the box goes to stdout as usual.
+ *
+ * int is 32 bits here rather than 16, so an overflow on the board won't
+ * show up in a host run. */
+
+#include <stdio.h>
+#include <ctype.h>
+
+#include "Arduino.h"
+#include "host.h"
+#include <avr/io.h>
+
+/* What the Arduino builder generates for the sketch. */
+void handleSerial(void);
+bool runSerialKey(char key);
+void runSerialLine(char *line);
+
+#include "BrewBot.ino"
+
+/* Stand-in for the sketch's own time on the board, per loop(). */
+#define LOOP_TIME  1000 // us
+
+/* Readings of the ladder, for each key. */
+#define ADC_NONE    1010
+#define ADC_RIGHT   1
+#define ADC_UP      146
+#define ADC_DOWN    334
+#define ADC_LEFT    507
+#define ADC_SELECT  740
+
+/* A tap is held this long, then let go for as long. */
+#define TAP_TIME  100 // ms
+
+#define MAX_PRESSES  256
+#define LINE_SIZE    128
+
+struct press
+{
+  int adc;
+  unsigned long ms;
+};
+
+static press presses[MAX_PRESSES];
+static unsigned int pressHead;
+static unsigned int pressTail;
+
+static Plant plantRIMS(PLANT_AMBIENT, PLANT_RIMS_POWER, PLANT_RIMS_MASS,
+                       PLANT_RIMS_LOSS, PLANT_AMBIENT, PLANT_BOIL,
+                       PLANT_RIMS_DEAD);
+static Plant plantBK(PLANT_AMBIENT, PLANT_BK_POWER, PLANT_BK_MASS,
+                     PLANT_BK_LOSS, PLANT_AMBIENT, PLANT_BOIL, PLANT_BK_DEAD);
+static int probeRIMS;
+static int probeBK;
+
+/* Plant time not yet run, and the us into the current ms. */
+static unsigned long pending;
+static unsigned long sub;
+
+#if DISPLAY_BACKEND == DISPLAY_TERMINAL
+/* The box TerminalBackend draws the screen in. */
+#define TERM_ROWS  (DISPLAY_ROWS + 2)
+#define TERM_COLS  (DISPLAY_COLS + 2)
+
+#define ESCAPE_SIZE  16
+
+static char term[TERM_ROWS][TERM_COLS];
+static int termX;
+static int termY;
+static int savedX;
+static int savedY;
+static char escape[ESCAPE_SIZE];
+static unsigned int escapeLength;
+#endif
+
+/* Longest loop() pass, by the finest probe resolution in use. */
+struct latency
+{
+  unsigned long passes;
+  unsigned long max;
+};
+
+static latency latencies[13];
+
+static bool showEvents;
+static bool showLatency;
+static bool blocking;
+static bool parasite;
+static uint8_t record[EVENT_LOG_RECORD_SIZE];
+static unsigned int recordLength;
+
+extern "C" void ADC_vect(void);
+
+static void queuePress(int adc, unsigned long ms)
+{
+  unsigned int next = (pressHead + 1) % MAX_PRESSES;
+
+  if (next != pressTail)
+  {
+    presses[pressHead].adc = adc;
+    presses[pressHead].ms = ms;
+    pressHead = next;
+  }
+}
+
+static bool pressing(void)
+{
+  return (pressHead != pressTail);
+}
+
+/* The ADC samples the ladder once a millisecond. */
+static void sampleKeys(void)
+{
+  int adc = ADC_NONE;
+
+  if (pressing())
+  {
+    press *p = &presses[pressTail];
+
+    adc = p->adc;
+    if (--p->ms == 0)
+    {
+      pressTail = (pressTail + 1) % MAX_PRESSES;
+    }
+  }
+
+  ADC = adc;
+  ADC_vect();
+}
+
+static void runPlants(void)
+{
+  double seconds = pending / 1000000.00;
+
+  plantRIMS.update(seconds);
+  plantBK.update(seconds);
+  pending = 0;
+
+  hostSetProbe(probeRIMS, plantRIMS.getTemp());
+  hostSetProbe(probeBK, plantBK.getTemp());
+}
+
+/* Keep the vessels and the keys in step with the clock. The elements are
+ * whatever the sketch last switched them to. */
+static void tick(unsigned long us)
+{
+  if ((rims_old_value != plantRIMS.getElement()) ||
+      (bk_old_value != plantBK.getElement()))
+  {
+    runPlants();
+    plantRIMS.setElement(rims_old_value);
+    plantBK.setElement(bk_old_value);
+  }
+
+  pending += us;
+  if (pending >= 100000)
+  {
+    runPlants();
+  }
+
+  for (sub += us; sub >= 1000; sub -= 1000)
+  {
+    sampleKeys();
+  }
+}
+
+#if DISPLAY_BACKEND == DISPLAY_TERMINAL
+/* Run the escape sequences TerminalBackend sends: clear, save and restore
+ * the cursor, move it, and set the scrolling region, which needs nothing
+ * here. */
+static void runEscape(void)
+{
+  if (escape[1] != '[')
+  {
+    if (escape[1] == '7')
+    {
+      savedX = termX;
+      savedY = termY;
+    }
+    else if (escape[1] == '8')
+    {
+      termX = savedX;
+      termY = savedY;
+    }
+
+    return;
+  }
+
+  int row = 1;
+  int col = 1;
+
+  escape[escapeLength] = '\0';
+  sscanf(escape + 2, "%d;%d", &row, &col);
+
+  switch (escape[escapeLength - 1])
+  {
+    case 'J':
+    {
+      memset(term, ' ', sizeof(term));
+      break;
+    }
+
+    case 'H':
+    {
+      termX = col - 1;
+      termY = row - 1;
+      break;
+    }
+  }
+}
+
+/* Draw into the box, and pass on whatever is printed below it. */
+static void textOut(uint8_t c)
+{
+  if (escapeLength != 0)
+  {
+    escape[escapeLength++] = c;
+
+    if (((escapeLength == 2) && (c != '[')) ||
+        ((escapeLength > 2) && isalpha(c)) ||
+        (escapeLength == ESCAPE_SIZE - 1))
+    {
+      runEscape();
+      escapeLength = 0;
+    }
+
+    return;
+  }
+
+  if (c == 0x1b)
+  {
+    escape[escapeLength++] = c;
+  }
+  else if (termY >= TERM_ROWS)
+  {
+    putchar(c);
+  }
+  else if (c == '\n')
+  {
+    termY++;
+  }
+  else if (c == '\r')
+  {
+    termX = 0;
+  }
+  else
+  {
+    if (termX < TERM_COLS)
+    {
+      term[termY][termX] = c;
+    }
+    termX++;
+  }
+}
+
+static const char *screenLine(uint8_t row)
+{
+  return &term[row + 1][1];
+}
+#else
+static void textOut(uint8_t c)
+{
+  putchar(c);
+}
+
+static const char *screenLine(uint8_t row)
+{
+  return hostLcdLine(row);
+}
+#endif
+
+/* Text goes straight out, event records are picked out by their sync
+ * byte, which is never sent as text. */
+static void serialOut(uint8_t c)
+{
+  if ((recordLength == 0) && (c != EVENT_LOG_SYNC))
+  {
+    textOut(c);
+    return;
+  }
+
+  record[recordLength++] = c;
+  if (recordLength < EVENT_LOG_RECORD_SIZE)
+  {
+    return;
+  }
+
+  recordLength = 0;
+
+  if (showEvents)
+  {
+    unsigned long time = record[1] | ((unsigned long)(record[2]) << 8) |
+                         ((unsigned long)(record[3]) << 16) |
+                         ((unsigned long)(record[4]) << 24);
+    int16_t value = record[6] | (record[7] << 8);
+
+    printf("event %lu %u %d\n", time, record[5], value);
+  }
+}
+
+static void showScreen(void)
+{
+  unsigned long seconds = hostTime() / 1000000;
+
+  printf("%lu:%02lu:%02lu |%.*s|\n", seconds / 3600, (seconds / 60) % 60,
+         seconds % 60, DISPLAY_COLS, screenLine(0));
+
+  for (unsigned int row = 1; row < DISPLAY_ROWS; row++)
+  {
+    printf("        |%.*s|\n", DISPLAY_COLS, screenLine(row));
+  }
+}
+
+/* Queue the presses for a run of keys like "D16 R U+3 S". */
+static bool queueKeys(char *keys)
+{
+  for (char *token = strtok(keys, " \t"); token != NULL;
+       token = strtok(NULL, " \t"))
+  {
+    int adc;
+
+    switch (toupper(token[0]))
+    {
+      case 'U':
+        adc = ADC_UP;
+        break;
+      case 'D':
+        adc = ADC_DOWN;
+        break;
+      case 'L':
+        adc = ADC_LEFT;
+        break;
+      case 'R':
+        adc = ADC_RIGHT;
+        break;
+      case 'S':
+        adc = ADC_SELECT;
+        break;
+      default:
+        return false;
+    }
+
+    if (token[1] == '+')
+    {
+      queuePress(adc, atof(token + 2) * 1000);
+      queuePress(ADC_NONE, TAP_TIME);
+      continue;
+    }
+
+    int count = (token[1] != '\0') ? atoi(token + 1) : 1;
+
+    while (count-- > 0)
+    {
+      queuePress(adc, TAP_TIME);
+      queuePress(ADC_NONE, TAP_TIME);
+    }
+  }
+
+  return true;
+}
+
+static void noteLatency(unsigned long us)
+{
+  uint8_t bits = hostProbeBits(probeRIMS);
+
+  if (hostProbeBits(probeBK) > bits)
+  {
+    bits = hostProbeBits(probeBK);
+  }
+
+  latency *l = &latencies[bits];
+
+  l->passes++;
+  if (us > l->max)
+  {
+    l->max = us;
+  }
+}
+
+static void printLatency(void)
+{
+  for (unsigned int bits = 9; bits <= 12; bits++)
+  {
+    if (latencies[bits].passes != 0)
+    {
+      printf("latency %u bits: passes=%lu max=%luus\n", bits,
+             latencies[bits].passes, latencies[bits].max);
+    }
+  }
+}
+
+/* Run a "max <stage> <us>" line, saying whether the stage kept to it. */
+static bool checkMax(char *args)
+{
+  char *name = strtok(args, " \t");
+  char *limit = strtok(NULL, " \t");
+
+  if ((name == NULL) || (limit == NULL))
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < NUM_PROFILES; i++)
+  {
+    if (strcmp(name, profileNames[i]) == 0)
+    {
+      unsigned long max = brewBot.profiler.getMax(i);
+      bool kept = (max <= strtoul(limit, NULL, 10));
+
+      printf("%s max=%luus: %s\n", name, max, kept ? "ok" : "FAILED");
+      return kept;
+    }
+  }
+
+  printf("%s: no such stage\n", name);
+  return false;
+}
+
+static void addProbe(uint8_t serial, int *probe)
+{
+  uint8_t rom[8] = { DS18B20MODEL, serial, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+  rom[7] = OneWire::crc8(rom, 7);
+  *probe = hostAddProbe(rom);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long long length = 0;
+  unsigned long long every = 0;
+  unsigned long long nextScreen = 0;
+  FILE *script = NULL;
+  char line[LINE_SIZE];
+  double lineTime = -1.00;
+  bool failed = false;
+  char *command = NULL;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+    {
+      length = atof(argv[++i]) * 60000000.00;
+    }
+    else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+    {
+      every = atof(argv[++i]) * 1000000.00;
+      nextScreen = every;
+    }
+    else if (strcmp(argv[i], "-e") == 0)
+    {
+      showEvents = true;
+    }
+    else if (strcmp(argv[i], "-l") == 0)
+    {
+      showLatency = true;
+    }
+    else if (strcmp(argv[i], "-b") == 0)
+    {
+      blocking = true;
+    }
+    else if (strcmp(argv[i], "-p") == 0)
+    {
+      parasite = true;
+    }
+    else if ((argv[i][0] != '-') && (script == NULL))
+    {
+      script = fopen(argv[i], "r");
+      if (script == NULL)
+      {
+        perror(argv[i]);
+        return 1;
+      }
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [-m minutes] [-s seconds] [-e] [-l] [-b] "
+              "[-p] [script]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if ((script == NULL) && (length == 0))
+  {
+    length = 10 * 60000000ULL;
+  }
+
+  hostSetParasite(parasite);
+  addProbe(0x01, &probeRIMS);
+  addProbe(0x02, &probeBK);
+  runPlants();
+
+  hostSetSerialOutput(serialOut);
+  hostSetTick(tick);
+
+  setup();
+
+  if (blocking)
+  {
+    brewBot.sensors.setWaitForConversion(true);
+  }
+
+  for (;;)
+  {
+    /* Run the script's lines as they come due. */
+    while ((script != NULL) && !pressing())
+    {
+      if (command == NULL)
+      {
+        if (fgets(line, sizeof(line), script) == NULL)
+        {
+          fclose(script);
+          script = NULL;
+          break;
+        }
+
+        line[strcspn(line, "\r\n")] = '\0';
+        command = line + strspn(line, " \t");
+        if ((*command == '#') || (*command == '\0'))
+        {
+          command = NULL;
+          continue;
+        }
+
+        lineTime = strtod(command, &command);
+        command += strspn(command, " \t");
+      }
+
+      if ((lineTime * 1000000.00) > hostTime())
+      {
+        break;
+      }
+
+      if (strncmp(command, "keys ", 5) == 0)
+      {
+        if (!queueKeys(command + 5))
+        {
+          fprintf(stderr, "bad keys at %.0fs\n", lineTime);
+          return 1;
+        }
+      }
+      else if (strncmp(command, "serial ", 7) == 0)
+      {
+        hostSerialInput(command + 7);
+        hostSerialInput("\n");
+      }
+      else if (strcmp(command, "screen") == 0)
+      {
+        showScreen();
+      }
+      else if (strncmp(command, "max ", 4) == 0)
+      {
+        if (!checkMax(command + 4))
+        {
+          failed = true;
+        }
+      }
+      else if (strcmp(command, "end") == 0)
+      {
+        length = hostTime();
+      }
+      else
+      {
+        fprintf(stderr, "bad command at %.0fs: %s\n", lineTime, command);
+        return 1;
+      }
+
+      command = NULL;
+    }
+
+    if ((length != 0) ? (hostTime() >= length) :
+        ((script == NULL) && !pressing()))
+    {
+      break;
+    }
+
+    unsigned long long start = hostTime();
+
+    loop();
+    noteLatency(hostTime() - start);
+    hostAdvance(LOOP_TIME);
+
+    if ((every != 0) && (hostTime() >= nextScreen))
+    {
+      showScreen();
+      nextScreen += every;
+    }
+  }
+
+  showScreen();
+
+  if (showLatency)
+  {
+    printLatency();
+  }
+
+  /* Any read before its conversion is done got a stale reading. */
+  if (hostEarlyReads() != 0)
+  {
+    printf("early probe reads: %lu: FAILED\n", hostEarlyReads());
+    failed = true;
+  }
+
+  return failed ? 1 : 0;
+}
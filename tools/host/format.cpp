@@ -0,0 +1,174 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/* Checks formatTemp() and formatTime() against the utoa/ultoa Display code
+ * they replaced, cell for cell, for every 1/16C value the seven cell field
+ * can hold (-999.94C to 999.94C, well past the probes' -55C to 125C) and
+ * every time from 0:00 to 9:59. Build and run from this directory with:
+ *
+ *   g++ -O2 -std=gnu++11 -DARDUINO=100 -I. -I../.. -o format format.cpp \
+ *       host.cpp ../../Format.cpp
+ *
+ * Prints any difference and exits with 1 if there was one. */
+
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "constants.h"
+#include "Format.h"
+
+#define CELLS  16
+
+/* Stand-ins for Display's frame helpers, as the old code used them. */
+static char cells[CELLS];
+
+static void clear(int x, int length)
+{
+  for (int i = 0; (i < length) && (x < CELLS); i++)
+  {
+    cells[x++] = ' ';
+  }
+}
+
+static void print(int x, const char *str)
+{
+  while ((*str != '\0') && (x < CELLS))
+  {
+    cells[x++] = *str++;
+  }
+}
+
+static void print(int x, char c)
+{
+  if (x < CELLS)
+  {
+    cells[x] = c;
+  }
+}
+
+/* Display::printTemp() before Format.cpp. */
+static void oldPrintTemp(int temp, int x)
+{
+  char buf[FORMAT_TEMP_SIZE + 1];
+  unsigned int whole;
+  unsigned int frac;
+  int pos;
+
+  clear(x, FORMAT_TEMP_SIZE);
+
+  if (temp < 0)
+  {
+    temp = -temp;
+    print(x, '-');
+  }
+
+  whole = temp >> TEMP_SHIFT;
+  frac = (((temp & (TEMP_ONE - 1)) * 100) + (TEMP_ONE / 2)) >> TEMP_SHIFT;
+
+  if (whole >= 100)
+  {
+    pos = x + 1;
+  }
+  else if (whole >= 10)
+  {
+    pos = x + 2;
+  }
+  else
+  {
+    pos = x + 3;
+  }
+
+  print(pos, utoa(whole, buf, 10));
+  pos += strlen(buf);
+
+  print(pos++, '.');
+  print(pos++, '0' + (frac / 10));
+  print(pos, '0' + (frac % 10));
+}
+
+/* Display::printTime() before Format.cpp, with the indicator showing. */
+static void oldPrintTime(unsigned long time, int x)
+{
+  char buf[11];
+  unsigned long mins = time % 60;
+
+  print(x, ultoa(time / 60, buf, 10));
+  print(x + 1, ':');
+
+  if (mins < 10)
+  {
+    print(x + 2, '0');
+    print(x + 3, ultoa(mins, buf, 10));
+  }
+  else
+  {
+    print(x + 2, ultoa(mins, buf, 10));
+  }
+}
+
+/* Both versions start from the same junk, so a cell either one misses
+ * shows up as a difference. */
+static bool same(const char *name, long value, const char *buf,
+                 unsigned int size)
+{
+  if (memcmp(cells, buf, size) == 0)
+  {
+    return true;
+  }
+
+  printf("%s %ld: old \"%.*s\" new \"%.*s\"\n", name, value, size, cells,
+         size, buf);
+  return false;
+}
+
+int main(void)
+{
+  unsigned long checked = 0;
+  unsigned long failed = 0;
+
+  for (int temp = -(1000 * TEMP_ONE) + 1; temp < (1000 * TEMP_ONE); temp++)
+  {
+    char buf[FORMAT_TEMP_SIZE];
+
+    memset(cells, '#', sizeof(cells));
+    memset(buf, '#', sizeof(buf));
+
+    oldPrintTemp(temp, 0);
+    formatTemp(buf, temp);
+
+    checked++;
+    failed += !same("temp", temp, buf, FORMAT_TEMP_SIZE);
+  }
+
+  for (unsigned long time = 0; time < 600; time++)
+  {
+    char buf[FORMAT_TIME_SIZE];
+
+    memset(cells, '#', sizeof(cells));
+    memset(buf, '#', sizeof(buf));
+
+    oldPrintTime(time, 0);
+    formatTime(buf, time);
+
+    checked++;
+    failed += !same("time", time, buf, FORMAT_TIME_SIZE);
+  }
+
+  printf("%lu checked, %lu different\n", checked, failed);
+
+  return (failed != 0) ? 1 : 0;
+}
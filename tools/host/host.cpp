@@ -0,0 +1,1014 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/* Stand-ins for the Arduino core and the libraries the sketch uses, on a
+ * virtual clock. Calls that would take time on the board charge it to the
+ * clock, using the timings below, so a profile taken on the host has the
+ * bus and display costs in the right places. The sketch's own code takes no
+ * time at all here; the host program charges a fixed amount per loop() for
+ * it instead. */
+
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "avr/io.h"
+#include "EEPROM.h"
+#include "Wire.h"
+#include "LiquidCrystal.h"
+#include "OneWire.h"
+#include "DallasTemperature.h"
+#include "DeviceManager.h"
+#include "BooleanDevice.h"
+#include "host.h"
+
+#include "I2CBackend.h"
+
+/* Costs, in us. */
+#define COST_DIGITAL_WRITE  4     // digitalWrite() on a 16MHz AVR
+#define COST_SPI_BYTE       1     // 8 bits at clock / 2, plus the wait
+#define COST_LCD_BYTE       270   // Two nibbles, each with a 100us settle
+#define COST_LCD_CLEAR      2270  // Plus the 2ms the clear takes
+#define COST_LCD_BEGIN      65000 // Power-up waits and the init sequence
+#define COST_OW_RESET       960   // Reset pulse and presence
+#define COST_OW_BYTE        560   // Eight 70us slots
+#define COST_OW_SEARCH      13440 // 64 bits of read, read, write slots
+#define COST_EEPROM_COPY    20000 // Probe copying its scratchpad to EEPROM
+#define COST_EEPROM_WRITE   3300  // One byte of the AVR's EEPROM
+#define COST_I2C_BYTE       90    // Nine bits at 100kHz
+#define COST_SERIAL_BYTE    1042  // Ten bits at 9600 baud
+
+#define SERIAL_TX_SIZE  64
+#define SERIAL_RX_SIZE  256
+
+#define MAX_PROBES  8
+
+static unsigned long long now;
+static void (*tick)(unsigned long us);
+
+static void (*serialOut)(uint8_t c);
+static char rxBuffer[SERIAL_RX_SIZE];
+static unsigned int rxHead;
+static unsigned int rxTail;
+static unsigned long long txBusy;
+
+static char lcd[HOST_LCD_ROWS][HOST_LCD_COLS + 1];
+static uint8_t lcdCol;
+static uint8_t lcdRow;
+
+static uint8_t relays;
+
+struct probe
+{
+  uint8_t rom[8];
+  double temp;
+  uint8_t bits;
+  int16_t scratch; // Last conversion's result, as a read returns it
+  bool converting;
+  unsigned long long done; // When the conversion will be
+};
+
+static probe probes[MAX_PROBES];
+static int numProbes;
+static bool parasitePower;
+static unsigned long earlyReads;
+
+static uint8_t eeprom[HOST_EEPROM_SIZE];
+static bool eepromErased;
+
+volatile uint8_t hostPorts[20];
+
+volatile uint8_t ADMUX;
+volatile uint8_t ADCSRA;
+volatile uint8_t ADCSRB;
+volatile uint8_t DIDR0;
+volatile uint16_t ADC;
+volatile uint8_t SPCR;
+volatile uint8_t SPSR;
+hostSPDR SPDR;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+/* Host side. */
+
+unsigned long long hostTime(void)
+{
+  return now;
+}
+
+void hostAdvance(unsigned long us)
+{
+  now += us;
+
+  if (tick != NULL)
+  {
+    tick(us);
+  }
+}
+
+void hostSetTick(void (*callback)(unsigned long us))
+{
+  tick = callback;
+}
+
+void hostSerialInput(const char *text)
+{
+  while (*text != '\0')
+  {
+    unsigned int next = (rxHead + 1) % SERIAL_RX_SIZE;
+
+    if (next == rxTail)
+    {
+      break;
+    }
+
+    rxBuffer[rxHead] = *text++;
+    rxHead = next;
+  }
+}
+
+void hostSetSerialOutput(void (*out)(uint8_t c))
+{
+  serialOut = out;
+}
+
+int hostAddProbe(const uint8_t *rom)
+{
+  if (numProbes >= MAX_PROBES)
+  {
+    return -1;
+  }
+
+  probe *p = &probes[numProbes];
+
+  memcpy(p->rom, rom, sizeof(p->rom));
+  p->temp = 20.00;
+  p->bits = 12;
+  p->scratch = 85 * 128; // What a DS18B20 powers up with
+  p->converting = false;
+
+  return numProbes++;
+}
+
+void hostSetProbe(int n, double temp)
+{
+  probes[n].temp = temp;
+}
+
+void hostSetParasite(bool parasite)
+{
+  parasitePower = parasite;
+}
+
+unsigned long hostEarlyReads(void)
+{
+  return earlyReads;
+}
+
+uint8_t hostProbeBits(int n)
+{
+  return probes[n].bits;
+}
+
+const char *hostLcdLine(uint8_t row)
+{
+  return lcd[row];
+}
+
+uint8_t hostRelays(void)
+{
+  return relays;
+}
+
+/* Core. */
+
+unsigned long millis(void)
+{
+  return now / 1000;
+}
+
+unsigned long micros(void)
+{
+  return now;
+}
+
+void delay(unsigned long ms)
+{
+  hostAdvance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  hostAdvance(us);
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  hostPorts[pin] = value;
+  hostAdvance(COST_DIGITAL_WRITE);
+}
+
+int digitalRead(uint8_t pin)
+{
+  return hostPorts[pin];
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t, uint8_t value)
+{
+  hostPorts[dataPin] = value & 1;
+  hostPorts[clockPin] = LOW;
+  relays = value;
+
+  /* Data, clock up, clock down for each bit. */
+  hostAdvance(8 * 3 * COST_DIGITAL_WRITE);
+}
+
+void attachInterrupt(uint8_t, void (*)(void), int)
+{
+}
+
+hostSPDR &hostSPDR::operator=(uint8_t value)
+{
+  _value = value;
+  relays = value;
+  SPSR |= (1 << SPIF);
+
+  hostAdvance(COST_SPI_BYTE);
+
+  return *this;
+}
+
+hostSPDR::operator uint8_t() const
+{
+  return _value;
+}
+
+static char *toBase(unsigned long value, char *buf, int base)
+{
+  char digits[33];
+  int n = 0;
+
+  do
+  {
+    int d = value % base;
+
+    digits[n++] = (d < 10) ? ('0' + d) : ('a' + d - 10);
+    value /= base;
+  } while (value != 0);
+
+  char *p = buf;
+  while (n > 0)
+  {
+    *p++ = digits[--n];
+  }
+  *p = '\0';
+
+  return buf;
+}
+
+char *itoa(int value, char *buf, int base)
+{
+  if ((value < 0) && (base == 10))
+  {
+    buf[0] = '-';
+    toBase(-(long)(value), buf + 1, base);
+    return buf;
+  }
+
+  return toBase((unsigned int)(value), buf, base);
+}
+
+char *utoa(unsigned int value, char *buf, int base)
+{
+  return toBase(value, buf, base);
+}
+
+char *ultoa(unsigned long value, char *buf, int base)
+{
+  return toBase(value, buf, base);
+}
+
+char *dtostrf(double value, signed char width, unsigned char prec, char *buf)
+{
+  sprintf(buf, "%*.*f", width, prec, value);
+  return buf;
+}
+
+char *dtostre(double value, char *buf, unsigned char prec, unsigned char)
+{
+  sprintf(buf, "%.*e", prec, value);
+  return buf;
+}
+
+size_t Print::write(const uint8_t *buf, size_t size)
+{
+  size_t n = 0;
+
+  while (size-- > 0)
+  {
+    n += write(*buf++);
+  }
+
+  return n;
+}
+
+size_t Print::print(const __FlashStringHelper *s)
+{
+  return print(reinterpret_cast<const char *>(s));
+}
+
+size_t Print::print(const char *s)
+{
+  return write((const uint8_t *)(s), strlen(s));
+}
+
+size_t Print::print(char c)
+{
+  return write(c);
+}
+
+size_t Print::print(unsigned char n, int base)
+{
+  return printNumber(n, base);
+}
+
+size_t Print::print(int n, int base)
+{
+  return print((long)(n), base);
+}
+
+size_t Print::print(unsigned int n, int base)
+{
+  return printNumber(n, base);
+}
+
+size_t Print::print(long n, int base)
+{
+  if ((n < 0) && (base == DEC))
+  {
+    return print('-') + printNumber(-n, base);
+  }
+
+  return printNumber(n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits)
+{
+  char buf[64];
+
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return print(buf);
+}
+
+size_t Print::printNumber(unsigned long n, int base)
+{
+  char buf[8 * sizeof(n) + 1];
+
+  return print(toBase(n, buf, (base < 2) ? DEC : base));
+}
+
+size_t Print::println(const __FlashStringHelper *s)
+{
+  return print(s) + println();
+}
+
+size_t Print::println(const char *s)
+{
+  return print(s) + println();
+}
+
+size_t Print::println(char c)
+{
+  return print(c) + println();
+}
+
+size_t Print::println(unsigned char n, int base)
+{
+  return print(n, base) + println();
+}
+
+size_t Print::println(int n, int base)
+{
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned int n, int base)
+{
+  return print(n, base) + println();
+}
+
+size_t Print::println(long n, int base)
+{
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long n, int base)
+{
+  return print(n, base) + println();
+}
+
+size_t Print::println(double n, int digits)
+{
+  return print(n, digits) + println();
+}
+
+size_t Print::println(void)
+{
+  return print("\r\n");
+}
+
+/* The TX buffer empties at the baud rate, and a write into a full one
+ * waits, as the core's does. */
+void HardwareSerial::begin(unsigned long)
+{
+  txBusy = now;
+}
+
+int HardwareSerial::available(void)
+{
+  return (rxHead + SERIAL_RX_SIZE - rxTail) % SERIAL_RX_SIZE;
+}
+
+int HardwareSerial::read(void)
+{
+  if (rxHead == rxTail)
+  {
+    return -1;
+  }
+
+  char c = rxBuffer[rxTail];
+  rxTail = (rxTail + 1) % SERIAL_RX_SIZE;
+
+  return (uint8_t)(c);
+}
+
+int HardwareSerial::availableForWrite(void)
+{
+  unsigned long long queued = 0;
+
+  if (txBusy > now)
+  {
+    queued = (txBusy - now + COST_SERIAL_BYTE - 1) / COST_SERIAL_BYTE;
+  }
+
+  return (queued >= (SERIAL_TX_SIZE - 1)) ? 0 :
+         ((SERIAL_TX_SIZE - 1) - queued);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  if (availableForWrite() == 0)
+  {
+    hostAdvance(txBusy - now - ((SERIAL_TX_SIZE - 2) * COST_SERIAL_BYTE));
+  }
+
+  txBusy = ((txBusy > now) ? txBusy : now) + COST_SERIAL_BYTE;
+
+  if (serialOut != NULL)
+  {
+    serialOut(c);
+  }
+  else
+  {
+    putchar(c);
+  }
+
+  return 1;
+}
+
+/* EEPROM. */
+
+static void eraseEEPROM(void)
+{
+  if (!eepromErased)
+  {
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    eepromErased = true;
+  }
+}
+
+uint8_t EEPROMClass::read(int addr)
+{
+  eraseEEPROM();
+  return eeprom[addr % HOST_EEPROM_SIZE];
+}
+
+void EEPROMClass::write(int addr, uint8_t value)
+{
+  eraseEEPROM();
+  eeprom[addr % HOST_EEPROM_SIZE] = value;
+  hostAdvance(COST_EEPROM_WRITE);
+}
+
+void EEPROMClass::update(int addr, uint8_t value)
+{
+  if (read(addr) != value)
+  {
+    write(addr, value);
+  }
+}
+
+/* The LCD, driven by either LiquidCrystal or the I2C backpack. */
+
+static void lcdClear(void)
+{
+  for (unsigned int row = 0; row < HOST_LCD_ROWS; row++)
+  {
+    memset(lcd[row], ' ', HOST_LCD_COLS);
+    lcd[row][HOST_LCD_COLS] = '\0';
+  }
+
+  lcdCol = 0;
+  lcdRow = 0;
+}
+
+static void lcdPut(uint8_t c)
+{
+  if ((lcdRow < HOST_LCD_ROWS) && (lcdCol < HOST_LCD_COLS))
+  {
+    lcd[lcdRow][lcdCol] = c;
+  }
+
+  lcdCol++;
+}
+
+/* I2C, sent on endTransmission() as the Wire library does. The bytes are
+ * the PCF8574's pins, which I2CBackend wires to the LCD's 4-bit bus. */
+
+static unsigned int wireBytes;
+static uint8_t wirePins;
+static bool lcdFourBit;
+static bool lcdHigh;
+static uint8_t lcdByte;
+
+/* An HD44780 instruction or character, as latched from the bus. */
+static void lcdRun(uint8_t value, bool data)
+{
+  if (data)
+  {
+    lcdPut(value);
+  }
+  else if (value & 0x80)
+  {
+    lcdCol = value & 0x3F;
+    lcdRow = (value & 0x40) ? 1 : 0;
+  }
+  else if (value == 0x01)
+  {
+    lcdClear();
+  }
+}
+
+/* The LCD latches a nibble as enable falls. Until it is told to go 4-bit,
+ * each nibble is a whole instruction. */
+static void lcdNibble(uint8_t pins)
+{
+  uint8_t nibble = pins & 0xF0;
+  bool data = pins & I2C_LCD_RS;
+
+  if (!lcdFourBit)
+  {
+    lcdFourBit = (nibble == 0x20);
+    return;
+  }
+
+  if (!lcdHigh)
+  {
+    lcdByte = nibble;
+    lcdHigh = true;
+    return;
+  }
+
+  lcdHigh = false;
+  lcdRun(lcdByte | (nibble >> 4), data);
+}
+
+void TwoWire::begin(void)
+{
+}
+
+void TwoWire::beginTransmission(uint8_t)
+{
+  wireBytes = 1;
+}
+
+uint8_t TwoWire::endTransmission(void)
+{
+  hostAdvance(wireBytes * COST_I2C_BYTE);
+  wireBytes = 0;
+
+  return 0;
+}
+
+size_t TwoWire::write(uint8_t pins)
+{
+  if ((wirePins & I2C_LCD_ENABLE) && !(pins & I2C_LCD_ENABLE))
+  {
+    lcdNibble(wirePins);
+  }
+
+  wirePins = pins;
+  wireBytes++;
+  return 1;
+}
+
+/* Parallel LCD. */
+
+LiquidCrystal::LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t,
+                             uint8_t)
+{
+}
+
+void LiquidCrystal::begin(uint8_t, uint8_t)
+{
+  hostAdvance(COST_LCD_BEGIN);
+  clear();
+}
+
+void LiquidCrystal::clear(void)
+{
+  lcdClear();
+
+  hostAdvance(COST_LCD_CLEAR);
+}
+
+void LiquidCrystal::setCursor(uint8_t col, uint8_t row)
+{
+  lcdCol = col;
+  lcdRow = row;
+
+  hostAdvance(COST_LCD_BYTE);
+}
+
+size_t LiquidCrystal::write(uint8_t c)
+{
+  lcdPut(c);
+
+  hostAdvance(COST_LCD_BYTE);
+
+  return 1;
+}
+
+/* 1-Wire. */
+
+static int findProbe(const uint8_t *rom)
+{
+  for (int i = 0; i < numProbes; i++)
+  {
+    if (memcmp(probes[i].rom, rom, sizeof(probes[i].rom)) == 0)
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+OneWire::OneWire(uint8_t)
+: _selected(-1), _written(0), _command(0), _searchNext(0)
+{
+}
+
+uint8_t OneWire::reset(void)
+{
+  _selected = -1;
+  _written = 0;
+
+  hostAdvance(COST_OW_RESET);
+
+  return (numProbes > 0);
+}
+
+void OneWire::select(const uint8_t *rom)
+{
+  _selected = findProbe(rom);
+  _written = 0;
+
+  hostAdvance(9 * COST_OW_BYTE);
+}
+
+void OneWire::skip(void)
+{
+  _selected = -1;
+  _written = 0;
+
+  hostAdvance(COST_OW_BYTE);
+}
+
+/* Only a write scratchpad to a selected probe is acted on. */
+void OneWire::write(uint8_t value, uint8_t)
+{
+  if (_written == 0)
+  {
+    _command = value;
+  }
+  else if (_written <= 3)
+  {
+    _scratch[_written - 1] = value;
+  }
+
+  _written++;
+
+  if ((_selected >= 0) && (_command == 0x4E) && (_written == 4))
+  {
+    probes[_selected].bits = ((_scratch[2] >> 5) & 0x03) + 9;
+  }
+
+  hostAdvance(COST_OW_BYTE);
+}
+
+void OneWire::reset_search(void)
+{
+  _searchNext = 0;
+}
+
+bool OneWire::search(uint8_t *rom)
+{
+  hostAdvance(COST_OW_RESET + COST_OW_SEARCH);
+
+  if (_searchNext >= numProbes)
+  {
+    return false;
+  }
+
+  memcpy(rom, probes[_searchNext++].rom, sizeof(probes[0].rom));
+
+  return true;
+}
+
+/* Dallas' CRC8, polynomial x^8 + x^5 + x^4 + 1. */
+uint8_t OneWire::crc8(const uint8_t *addr, uint8_t len)
+{
+  uint8_t crc = 0;
+
+  while (len-- > 0)
+  {
+    uint8_t b = *addr++;
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      uint8_t mix = (crc ^ b) & 0x01;
+
+      crc >>= 1;
+      if (mix)
+      {
+        crc ^= 0x8C;
+      }
+      b >>= 1;
+    }
+  }
+
+  return crc;
+}
+
+/* DS18B20s. */
+
+DallasTemperature::DallasTemperature(OneWire *oneWire)
+: _oneWire(oneWire), _wait(true)
+{
+}
+
+void DallasTemperature::begin(void)
+{
+  uint8_t rom[8];
+
+  _oneWire->reset_search();
+  while (_oneWire->search(rom));
+}
+
+uint8_t DallasTemperature::getDeviceCount(void)
+{
+  return numProbes;
+}
+
+bool DallasTemperature::getAddress(uint8_t *addr, uint8_t index)
+{
+  if (index >= numProbes)
+  {
+    return false;
+  }
+
+  memcpy(addr, probes[index].rom, sizeof(probes[index].rom));
+
+  return true;
+}
+
+bool DallasTemperature::validAddress(const uint8_t *addr)
+{
+  return (OneWire::crc8(addr, 7) == addr[7]);
+}
+
+bool DallasTemperature::validFamily(const uint8_t *addr)
+{
+  return ((addr[0] == DS18S20MODEL) || (addr[0] == DS18B20MODEL));
+}
+
+/* A scratchpad read: reset, select, command and nine bytes back. */
+bool DallasTemperature::isConnected(const uint8_t *addr)
+{
+  _oneWire->reset();
+  _oneWire->select(addr);
+  hostAdvance(10 * COST_OW_BYTE);
+
+  return (findProbe(addr) >= 0);
+}
+
+bool DallasTemperature::setResolution(const uint8_t *addr, uint8_t bits,
+                                      bool)
+{
+  int n = findProbe(addr);
+
+  if (!isConnected(addr) || (n < 0))
+  {
+    return false;
+  }
+
+  _oneWire->reset();
+  _oneWire->select(addr);
+  hostAdvance(4 * COST_OW_BYTE + COST_EEPROM_COPY);
+
+  probes[n].bits = bits;
+
+  return true;
+}
+
+bool DallasTemperature::isParasitePowerMode(void)
+{
+  return parasitePower;
+}
+
+void DallasTemperature::setWaitForConversion(bool wait)
+{
+  _wait = wait;
+}
+
+int16_t DallasTemperature::millisToWaitForConversion(uint8_t bits)
+{
+  switch (bits)
+  {
+    case 9:
+      return 94;
+    case 10:
+      return 188;
+    case 11:
+      return 375;
+    default:
+      return 750;
+  }
+}
+
+void DallasTemperature::requestTemperatures(void)
+{
+  _oneWire->reset();
+  _oneWire->skip();
+  _oneWire->write(0x44);
+
+  for (int n = 0; n < numProbes; n++)
+  {
+    probes[n].converting = true;
+    probes[n].done = hostTime() +
+                     millisToWaitForConversion(probes[n].bits) * 1000ULL;
+  }
+
+  /* Like the library, wait for the finest resolution on the bus. */
+  if (_wait)
+  {
+    uint8_t bits = 9;
+
+    for (int n = 0; n < numProbes; n++)
+    {
+      if (probes[n].bits > bits)
+      {
+        bits = probes[n].bits;
+      }
+    }
+
+    hostAdvance(millisToWaitForConversion(bits) * 1000UL);
+  }
+}
+
+/* The probe's temperature as raw 1/128C, truncated to its resolution. */
+static int16_t convert(probe *p)
+{
+  int shift = 12 - p->bits;
+  long sixteenths = (long)(floor(p->temp * 16.00));
+
+  return (int16_t)(((sixteenths >> shift) << shift) * 8);
+}
+
+/* The scratchpad, which only takes a new reading once a conversion is done,
+ * taken as the temperature when it is read. Reading a probe still
+ * converting gets the last reading, or 85C if there hasn't been one, and is
+ * counted. On parasite power it also cuts short the conversions of every
+ * other probe, as the bus stops powering them. */
+int16_t DallasTemperature::getTemp(const uint8_t *addr)
+{
+  int n = findProbe(addr);
+
+  if (!isConnected(addr) || (n < 0))
+  {
+    return DEVICE_DISCONNECTED_RAW;
+  }
+
+  probe *p = &probes[n];
+
+  if (p->converting && (hostTime() >= p->done))
+  {
+    p->scratch = convert(p);
+    p->converting = false;
+  }
+
+  if (p->converting)
+  {
+    earlyReads++;
+  }
+
+  if (parasitePower)
+  {
+    for (int i = 0; i < numProbes; i++)
+    {
+      if (probes[i].converting && (hostTime() < probes[i].done))
+      {
+        if (i != n)
+        {
+          earlyReads++;
+        }
+        probes[i].converting = false;
+      }
+    }
+  }
+
+  return p->scratch;
+}
+
+float DallasTemperature::getTempC(const uint8_t *addr)
+{
+  int16_t raw = getTemp(addr);
+
+  if (raw == DEVICE_DISCONNECTED_RAW)
+  {
+    return DEVICE_DISCONNECTED_C;
+  }
+
+  return raw / 128.00;
+}
+
+/* Devices. */
+
+void DeviceManager::TickAll(void)
+{
+}
+
+void DeviceManager::ProcessMessages(void)
+{
+}
+
+void DeviceManager::ReportStatusUpdates(void)
+{
+}
+
+BooleanDevice::BooleanDevice(uint8_t pin, bool value, bool)
+: _pin(pin), _value(value)
+{
+}
+
+void BooleanDevice::Setup(unsigned int)
+{
+  pinMode(_pin, OUTPUT);
+  Write(_value);
+}
+
+void BooleanDevice::Write(bool value)
+{
+  _value = value;
+  digitalWrite(_pin, value ? HIGH : LOW);
+}
+
+bool BooleanDevice::Read(void)
+{
+  return _value;
+}
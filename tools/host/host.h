@@ -0,0 +1,58 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+/* What a host program uses to drive the stand-ins in host.cpp. */
+
+/* Virtual time in us. It only moves when hostAdvance() is called, by the
+ * program or by a stand-in charging what its hardware would take. */
+unsigned long long hostTime(void);
+void hostAdvance(unsigned long us);
+
+/* Called with every advance, to keep whatever is simulated in step. */
+void hostSetTick(void (*tick)(unsigned long us));
+
+/* Serial input is queued for the sketch to read; output goes to the hook,
+ * or stdout if there isn't one. */
+void hostSerialInput(const char *text);
+void hostSetSerialOutput(void (*out)(uint8_t c));
+
+/* Add a DS18B20 to the bus, returning its number for hostSetProbe(). */
+int hostAddProbe(const uint8_t *rom);
+void hostSetProbe(int probe, double temp);
+
+/* Whether the probes are on parasite power, as begin() will find them. */
+void hostSetParasite(bool parasite);
+
+/* Probe reads, or conversions cut short on parasite power, that came before
+ * a conversion was done. */
+unsigned long hostEarlyReads(void);
+
+/* Resolution a probe is converting at, in bits. */
+uint8_t hostProbeBits(int probe);
+
+/* A row of the LCD, parallel or I2C, as it would be showing. */
+const char *hostLcdLine(uint8_t row);
+
+/* The relay frame last latched, by shiftOut() or SPI. */
+uint8_t hostRelays(void);
+
+#endif
@@ -0,0 +1,897 @@
+/******************************************************************************
+ * Copyright (c) 2013 Patrick Colp
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Host simulation of the sketch's temperature control against the
+ * simulated plant. Uses the same Plant, Pid, Modulator, Autotune and
+ * PowerArbiter code as the sketch; those are kept free of the Arduino core
+ * so they build here as they are. The timing is the sketch's too:
+ * half-cycles at MAINS_HZ, probe readings in whole 1/16C every SENSOR_TIME,
+ * and the controller every PID_TIME, all in plant seconds. Only the host's
+ * clock is sped up: a run takes as long as the host needs to step through
+ * it. Build and run from this directory with:
+ *
+ *   g++ -O2 -std=c++11 -pthread -I.. -o simulate simulate.cpp ../Plant.cpp \
+ *       ../Pid.cpp ../Modulator.cpp ../Autotune.cpp ../PowerArbiter.cpp -lm
+ *
+ *   ./simulate ripple     compare the element modulation modes at a mash rest
+ *   ./simulate tune       autotune the RIMS and compare against the defaults
+ *   ./simulate schedule   time a mash schedule with and without set point
+ *                         ramping and preheating into the next rest
+ *   ./simulate concurrent time the mash and heating the sparge water in the
+ *                         kettle one after the other, and at the same time
+ *   ./simulate sweep [n]  rank a grid of gains and modulation settings over a
+ *                         mash schedule, on n threads (default all cores)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "constants.h"
+#include "Plant.h"
+#include "Pid.h"
+#include "Modulator.h"
+#include "Autotune.h"
+#include "PowerArbiter.h"
+
+#define SIM_TARGET  (65.00)   // C
+#define SIM_BAND    (0.50)    // C either side of target counted as there
+#define SIM_SETTLE  (600.00)  // Plant seconds after first reaching target
+#define SIM_HOLD    (1800.00) // Plant seconds measured
+#define SIM_LENGTH  (7200.00) // Plant seconds for a heat-up
+#define SIM_RAMP    (TEMP_ONE / 2) // 1/16C per minute, slower than the RIMS
+
+/* Gives the demand for a probe reading (1/16C). */
+typedef double (*controller)(void *cookie, double input);
+
+struct result
+{
+  double reached;   // Plant seconds to first reach the band
+  double overshoot; // C past target
+  double minTemp;   // Over the hold
+  double maxTemp;
+  double rms;
+  unsigned long switches;
+};
+
+static double computePid(void *cookie, double input)
+{
+  return ((Pid *)(cookie))->compute(input);
+}
+
+static double computeAutotune(void *cookie, double input)
+{
+  return ((Autotune *)(cookie))->compute(input);
+}
+
+/* Heat the RIMS from ambient and hold it at SIM_TARGET for plant seconds,
+ * or until done() says so. */
+static void simulate(controller control, void *cookie, unsigned char mode,
+                     double length, bool (*done)(void *cookie), result *r)
+{
+  Plant plant(PLANT_AMBIENT, PLANT_RIMS_POWER, PLANT_RIMS_MASS,
+              PLANT_RIMS_LOSS, PLANT_AMBIENT, PLANT_BOIL, PLANT_RIMS_DEAD);
+  Modulator mod(mode, ELEMENT_WINDOW, ELEMENT_STEPS);
+
+  const unsigned long halfCycles = MAINS_HZ * 2;
+  const double dt = 1.00 / halfCycles;
+  const unsigned long pidCycles = (halfCycles * PID_TIME) / 1000;
+  const unsigned long sensorCycles = (halfCycles * SENSOR_TIME) / 1000;
+
+  double probe = floor(plant.getTemp() * TEMP_ONE);
+  double sum = 0.00;
+  unsigned long samples = 0;
+  bool element = false;
+
+  memset(r, 0, sizeof(*r));
+  r->reached = -1.00;
+  r->minTemp = 1000.00;
+  r->maxTemp = -1000.00;
+
+  for (unsigned long n = 0; (n * dt) < length; n++)
+  {
+    double t = n * dt;
+
+    if ((n % sensorCycles) == 0)
+    {
+      probe = floor(plant.getTemp() * TEMP_ONE);
+    }
+
+    if ((n % pidCycles) == 0)
+    {
+      if ((done != NULL) && done(cookie))
+      {
+        break;
+      }
+
+      mod.setDemand(control(cookie, probe));
+    }
+
+    bool on = mod.step();
+    plant.setElement(on);
+    plant.update(dt);
+
+    double temp = plant.getTemp();
+
+    if ((temp - SIM_TARGET) > r->overshoot)
+    {
+      r->overshoot = temp - SIM_TARGET;
+    }
+
+    if (r->reached < 0.00)
+    {
+      if (temp >= (SIM_TARGET - SIM_BAND))
+      {
+        r->reached = t;
+      }
+      continue;
+    }
+
+    if ((t < (r->reached + SIM_SETTLE)) ||
+        (t >= (r->reached + SIM_SETTLE + SIM_HOLD)))
+    {
+      continue;
+    }
+
+    if (temp < r->minTemp)
+    {
+      r->minTemp = temp;
+    }
+
+    if (temp > r->maxTemp)
+    {
+      r->maxTemp = temp;
+    }
+
+    sum += (temp - SIM_TARGET) * (temp - SIM_TARGET);
+    samples++;
+
+    if (on != element)
+    {
+      r->switches++;
+      element = on;
+    }
+  }
+
+  r->rms = (samples != 0) ? sqrt(sum / samples) : 0.00;
+}
+
+static void ripple(void)
+{
+  const char *names[] = { "burst", "window" };
+  const unsigned char modes[] = { MODULATOR_BURST, MODULATOR_WINDOW };
+
+  printf("mode     ripple(C)  rms(C)   switches/min\n");
+
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    Pid pid(PID_RIMS_KP, PID_RIMS_KI, PID_RIMS_KD, PID_TIME / 1000.00);
+    result r;
+
+    pid.setSetpoint(SIM_TARGET * TEMP_ONE);
+    pid.enable(true);
+
+    simulate(computePid, &pid, modes[i], SIM_LENGTH, NULL, &r);
+    printf("%-8s %-10.4f %-8.4f %.1f\n", names[i], r.maxTemp - r.minTemp,
+           r.rms, r.switches / (SIM_HOLD / 60.00));
+  }
+}
+
+static bool autotuneDone(void *cookie)
+{
+  return (((Autotune *)(cookie))->getState() != AUTOTUNE_RUNNING);
+}
+
+static void step(const char *name, double kp, double ki, double kd)
+{
+  Pid pid(kp, ki, kd, PID_TIME / 1000.00);
+  result r;
+
+  pid.setSetpoint(SIM_TARGET * TEMP_ONE);
+  pid.enable(true);
+
+  simulate(computePid, &pid, ELEMENT_MODULATION, SIM_LENGTH, NULL, &r);
+  printf("%-8s %-9.4f %-9.6f %-9.4f %-11.1f %-12.3f %.4f\n", name, kp, ki,
+         kd, r.reached / 60.00, r.overshoot, r.rms);
+}
+
+static int tune(void)
+{
+  Autotune autotune(PID_TIME / 1000.00);
+  result r;
+
+  autotune.start(SIM_TARGET * TEMP_ONE, AUTOTUNE_HYSTERESIS);
+  simulate(computeAutotune, &autotune, ELEMENT_MODULATION,
+           AUTOTUNE_TIMEOUT, autotuneDone, &r);
+
+  if (autotune.getState() != AUTOTUNE_DONE)
+  {
+    printf("autotune failed\n");
+    return 1;
+  }
+
+  printf("Ku %.4f Pu %.1fs after %.1fs\n\n", autotune.getUltimateGain(),
+         autotune.getUltimatePeriod(), autotune.getElapsed());
+
+  printf("gains    kp        ki        kd        reached(min) overshoot(C) "
+         "rms(C)\n");
+  step("default", PID_RIMS_KP, PID_RIMS_KI, PID_RIMS_KD);
+  step("tuned", autotune.getKp(), autotune.getKi(), 0.00);
+
+  return 0;
+}
+
+/* Mash schedule for the sweep: target (C) and hold (plant minutes). */
+static const double sweepSteps[][2] =
+{
+  { 52.00, 15.00 }, { 65.00, 60.00 }, { 76.00, 10.00 }
+};
+#define SWEEP_STEPS  (sizeof(sweepSteps) / sizeof(sweepSteps[0]))
+
+/* Grid searched. */
+static const double sweepKp[] = { 0.005, 0.01, 0.02, 0.05, 0.10, 0.20, 0.50,
+                                  1.00 };
+static const double sweepKi[] = { 0.00, 0.0001, 0.0003, 0.001, 0.003, 0.01,
+                                  0.03, 0.10 };
+static const double sweepKd[] = { 0.00, 0.01, 0.03, 0.10, 0.30 };
+static const unsigned int sweepWindow[] = { 0, 120, 360, 720 }; // 0 = burst
+
+#define SWEEP_COUNT(a)  (sizeof(a) / sizeof(a[0]))
+
+/* Time allowed to reach each step before it counts as never reached. */
+#define SWEEP_TIMEOUT  (120.00 * 60.00) // Plant seconds
+
+struct candidate
+{
+  double kp;
+  double ki;
+  double kd;
+  unsigned int window;
+
+  double settle;    // Plant minutes spent getting into band, all steps
+  double overshoot; // Worst C past a target
+  double inBand;    // Fraction of the holds spent in band
+  double rms;       // C from target over the holds
+  double score;     // Lower is better
+};
+
+/* Run the mash schedule. Each step heats into band, then holds for its time
+ * while the fraction spent in band is counted. */
+static void runSchedule(candidate *c)
+{
+  Plant plant(PLANT_AMBIENT, PLANT_RIMS_POWER, PLANT_RIMS_MASS,
+              PLANT_RIMS_LOSS, PLANT_AMBIENT, PLANT_BOIL, PLANT_RIMS_DEAD);
+  Pid pid(c->kp, c->ki, c->kd, PID_TIME / 1000.00);
+  Modulator mod(c->window ? MODULATOR_WINDOW : MODULATOR_BURST, c->window,
+                ELEMENT_STEPS);
+
+  const unsigned long halfCycles = MAINS_HZ * 2;
+  const double dt = 1.00 / halfCycles;
+  const unsigned long pidCycles = (halfCycles * PID_TIME) / 1000;
+  const unsigned long sensorCycles = (halfCycles * SENSOR_TIME) / 1000;
+
+  double probe = floor(plant.getTemp() * TEMP_ONE);
+  double held = 0.00;
+  double band = 0.00;
+  double squares = 0.00;
+  unsigned long n = 0;
+
+  c->settle = 0.00;
+  c->overshoot = 0.00;
+
+  pid.enable(true);
+
+  for (unsigned int i = 0; i < SWEEP_STEPS; i++)
+  {
+    double target = sweepSteps[i][0];
+    double hold = sweepSteps[i][1] * 60.00;
+    double start = n * dt;
+    double reached = -1.00;
+
+    pid.setSetpoint(target * TEMP_ONE);
+
+    for (;; n++)
+    {
+      double t = n * dt;
+
+      if ((n % sensorCycles) == 0)
+      {
+        probe = floor(plant.getTemp() * TEMP_ONE);
+      }
+
+      if ((n % pidCycles) == 0)
+      {
+        mod.setDemand(pid.compute(probe));
+      }
+
+      plant.setElement(mod.step());
+      plant.update(dt);
+
+      double temp = plant.getTemp();
+      bool inBand = (fabs(temp - target) <= SIM_BAND);
+
+      if ((temp - target) > c->overshoot)
+      {
+        c->overshoot = temp - target;
+      }
+
+      if (reached < 0.00)
+      {
+        if (inBand)
+        {
+          reached = t;
+          c->settle += (t - start) / 60.00;
+        }
+        else if ((t - start) > SWEEP_TIMEOUT)
+        {
+          /* Never got there; count the whole hold as out of band. */
+          c->settle += SWEEP_TIMEOUT / 60.00;
+          held += hold;
+          squares += (temp - target) * (temp - target) * hold;
+          break;
+        }
+
+        continue;
+      }
+
+      if (t >= (reached + hold))
+      {
+        break;
+      }
+
+      held += dt;
+      squares += (temp - target) * (temp - target) * dt;
+      if (inBand)
+      {
+        band += dt;
+      }
+    }
+  }
+
+  c->inBand = (held > 0.00) ? (band / held) : 0.00;
+  c->rms = (held > 0.00) ? sqrt(squares / held) : 0.00;
+
+  /* In minutes: a minute late into band weighs the same as 1% of the holds
+   * out of band, 0.01C of RMS error over them, or 0.03C of overshoot. The
+   * heat-up takes most of the settle time whatever the gains, so it is the
+   * last three that set the candidates apart. */
+  c->score = c->settle + ((1.00 - c->inBand) * 100.00) + (c->rms * 100.00) +
+             (c->overshoot * 30.00);
+}
+
+/* Ramp rate in 1/16C per minute as a set point rise per second, as
+ * BrewBot::setup() does with the timer running at its real rate. */
+static double rampRate(double ramp)
+{
+  return ramp / 60.00;
+}
+
+struct brewDay
+{
+  double length;    // Plant minutes until the last rest is over
+  double overshoot; // Worst C past a target
+  double inBand;    // Fraction of the rests spent in band
+};
+
+/* Run the sweep's mash schedule with the default gains, timing each rest
+ * from when it is first in band. With preheat the set point moves to the
+ * next rest's target as soon as the time left in this one is less than
+ * the heat-up will take, as UI::preheat() does. */
+static void runBrewDay(double ramp, unsigned int preheat, brewDay *b)
+{
+  Plant plant(PLANT_AMBIENT, PLANT_RIMS_POWER, PLANT_RIMS_MASS,
+              PLANT_RIMS_LOSS, PLANT_AMBIENT, PLANT_BOIL, PLANT_RIMS_DEAD);
+  Pid pid(PID_RIMS_KP, PID_RIMS_KI, PID_RIMS_KD, PID_TIME / 1000.00);
+  Modulator mod(ELEMENT_MODULATION, ELEMENT_WINDOW, ELEMENT_STEPS);
+
+  const unsigned long halfCycles = MAINS_HZ * 2;
+  const double dt = 1.00 / halfCycles;
+  const unsigned long pidCycles = (halfCycles * PID_TIME) / 1000;
+  const unsigned long sensorCycles = (halfCycles * SENSOR_TIME) / 1000;
+
+  double probe = floor(plant.getTemp() * TEMP_ONE);
+  double held = 0.00;
+  double band = 0.00;
+  unsigned long n = 0;
+
+  b->overshoot = 0.00;
+
+  pid.setRamp(rampRate(ramp));
+  pid.setSetpoint(sweepSteps[0][0] * TEMP_ONE);
+  pid.enable(true);
+
+  for (unsigned int i = 0; i < SWEEP_STEPS; i++)
+  {
+    double target = sweepSteps[i][0];
+    double hold = sweepSteps[i][1] * 60.00;
+    double reached = -1.00;
+    bool early = false;
+
+    pid.setSetpoint(target * TEMP_ONE);
+
+    for (;; n++)
+    {
+      double t = n * dt;
+
+      if ((n % sensorCycles) == 0)
+      {
+        probe = floor(plant.getTemp() * TEMP_ONE);
+      }
+
+      if ((n % pidCycles) == 0)
+      {
+        if (preheat && !early && (reached >= 0.00) &&
+            ((i + 1) < SWEEP_STEPS) && (sweepSteps[i + 1][0] > target))
+        {
+          double rate = pid.getRiseRate();
+
+          if ((pid.getRamp() > 0.00) &&
+              ((rate <= 0.00) || (pid.getRamp() < rate)))
+          {
+            rate = pid.getRamp();
+          }
+
+          if ((rate > 0.00) &&
+              ((reached + hold - t) <=
+               ((sweepSteps[i + 1][0] - target) * TEMP_ONE * preheat /
+                (rate * 100.00))))
+          {
+            pid.setSetpoint(sweepSteps[i + 1][0] * TEMP_ONE);
+            early = true;
+          }
+        }
+
+        mod.setDemand(pid.compute(probe));
+      }
+
+      plant.setElement(mod.step());
+      plant.update(dt);
+
+      double temp = plant.getTemp();
+      bool inBand = (fabs(temp - target) <= SIM_BAND);
+
+      if (!early && ((temp - target) > b->overshoot))
+      {
+        b->overshoot = temp - target;
+      }
+
+      if (reached < 0.00)
+      {
+        if (inBand)
+        {
+          reached = t;
+        }
+
+        continue;
+      }
+
+      if (t >= (reached + hold))
+      {
+        break;
+      }
+
+      held += dt;
+      if (inBand)
+      {
+        band += dt;
+      }
+    }
+  }
+
+  b->length = (n * dt) / 60.00;
+  b->inBand = (held > 0.00) ? (band / held) : 0.00;
+}
+
+/* Compare stepping the set point at the end of each rest against ramping
+ * it and preheating into the next rest, by half and all of the way. */
+static void schedule(void)
+{
+  const char *names[] = { "step", "ramp", "preheat 50%", "preheat 100%",
+                          "ramp+preheat 50%" };
+  const double ramps[] = { 0.00, SIM_RAMP, 0.00, 0.00, SIM_RAMP };
+  const unsigned int preheats[] = { 0, 0, 50, 100, 50 };
+  brewDay base;
+
+  memset(&base, 0, sizeof(base));
+
+  printf("mode              brew-day(min) saved(min) overshoot(C) "
+         "in-band\n");
+
+  for (unsigned int i = 0; i < SWEEP_COUNT(names); i++)
+  {
+    brewDay b;
+
+    runBrewDay(ramps[i], preheats[i], &b);
+    if (i == 0)
+    {
+      base = b;
+    }
+
+    printf("%-17s %-13.1f %-10.1f %-12.3f %.3f\n", names[i], b.length,
+           base.length - b.length, b.overshoot, b.inBand);
+  }
+}
+
+/* Kettle work done alongside the mash: heat the sparge water and hold it
+ * until it is wanted. Target (C) and hold (plant minutes). */
+static const double kettleSteps[][2] =
+{
+  { 76.00, 20.00 }
+};
+#define KETTLE_STEPS  (sizeof(kettleSteps) / sizeof(kettleSteps[0]))
+
+/* A vessel working through its steps, each timed from when it is first in
+ * band as the UI does. */
+struct vessel
+{
+  vessel(double power, double mass, double loss, double dead, double kp,
+         double ki, double kd, const double (*steps)[2],
+         unsigned int numSteps)
+  : plant(PLANT_AMBIENT, power, mass, loss, PLANT_AMBIENT, PLANT_BOIL, dead),
+    pid(kp, ki, kd, PID_TIME / 1000.00),
+    mod(ELEMENT_MODULATION, ELEMENT_WINDOW, ELEMENT_STEPS), steps(steps),
+    numSteps(numSteps), step(0), reached(-1.00), finished(-1.00),
+    started(false)
+  {
+    probe = floor(plant.getTemp() * TEMP_ONE);
+  }
+
+  void start(void)
+  {
+    started = true;
+    pid.setSetpoint(steps[0][0] * TEMP_ONE);
+    pid.enable(true);
+  }
+
+  bool isRunning(void)
+  {
+    return (started && (finished < 0.00));
+  }
+
+  /* Move on once the step has been held for its time. */
+  void advance(double t)
+  {
+    if (!isRunning())
+    {
+      return;
+    }
+
+    if (reached < 0.00)
+    {
+      if (fabs(plant.getTemp() - steps[step][0]) <= SIM_BAND)
+      {
+        reached = t;
+      }
+
+      return;
+    }
+
+    if (t < (reached + (steps[step][1] * 60.00)))
+    {
+      return;
+    }
+
+    reached = -1.00;
+
+    if (++step >= numSteps)
+    {
+      finished = t;
+      pid.enable(false);
+      mod.setDemand(0.00);
+      return;
+    }
+
+    pid.setSetpoint(steps[step][0] * TEMP_ONE);
+  }
+
+  Plant plant;
+  Pid pid;
+  Modulator mod;
+
+  const double (*steps)[2];
+  unsigned int numSteps;
+  unsigned int step;
+
+  double probe;
+  double reached;  // Plant seconds, -1 until in band
+  double finished; // Plant seconds, -1 until done
+  bool started;
+};
+
+/* Run the mash in the RIMS and the kettle's work, either with the kettle
+ * waiting for the mash or both at once, sharing the supply through the
+ * arbiter. Gives the plant minutes until both are done. */
+static double runVessels(bool concurrent, unsigned int *shortfall)
+{
+  vessel rims(PLANT_RIMS_POWER, PLANT_RIMS_MASS, PLANT_RIMS_LOSS,
+              PLANT_RIMS_DEAD, PID_RIMS_KP, PID_RIMS_KI, PID_RIMS_KD,
+              sweepSteps, SWEEP_STEPS);
+  vessel bk(PLANT_BK_POWER, PLANT_BK_MASS, PLANT_BK_LOSS, PLANT_BK_DEAD,
+            PID_BK_KP, PID_BK_KI, PID_BK_KD, kettleSteps, KETTLE_STEPS);
+  PowerArbiter arbiter(POWER_LIMIT);
+
+  const unsigned long halfCycles = MAINS_HZ * 2;
+  const double dt = 1.00 / halfCycles;
+  const unsigned long pidCycles = (halfCycles * PID_TIME) / 1000;
+  const unsigned long sensorCycles = (halfCycles * SENSOR_TIME) / 1000;
+
+  int loadRIMS = arbiter.addLoad(ELEMENT_RIMS_POWER);
+  int loadBK = arbiter.addLoad(ELEMENT_BK_POWER);
+  int loads[] = { loadRIMS, loadBK };
+  double t = 0.00;
+
+  rims.start();
+  if (concurrent)
+  {
+    bk.start();
+  }
+
+  for (unsigned long n = 0; rims.isRunning() || bk.isRunning() ||
+       !bk.started; n++)
+  {
+    vessel *vessels[] = { &rims, &bk };
+
+    t = n * dt;
+
+    for (unsigned int i = 0; i < 2; i++)
+    {
+      vessel *v = vessels[i];
+
+      if ((n % sensorCycles) == 0)
+      {
+        v->probe = floor(v->plant.getTemp() * TEMP_ONE);
+      }
+
+      if (((n % pidCycles) == 0) && v->isRunning())
+      {
+        v->mod.setDemand(v->pid.compute(v->probe));
+      }
+
+      if (v->mod.getDemand() == 0)
+      {
+        arbiter.cancel(loads[i]);
+      }
+    }
+
+    unsigned int want = 0;
+
+    if (rims.mod.step())
+    {
+      want |= (1 << loadRIMS);
+    }
+
+    if (bk.mod.step())
+    {
+      want |= (1 << loadBK);
+    }
+
+    unsigned int on = arbiter.step(want);
+
+    rims.plant.setElement(on & (1 << loadRIMS));
+    bk.plant.setElement(on & (1 << loadBK));
+
+    for (unsigned int i = 0; i < 2; i++)
+    {
+      vessels[i]->plant.update(dt);
+      vessels[i]->advance(t);
+    }
+
+    /* One at a time, the kettle is only started once the mash is done. */
+    if (!bk.started && !rims.isRunning())
+    {
+      bk.start();
+    }
+  }
+
+  *shortfall = std::max(arbiter.getShortfall(loadRIMS),
+                        arbiter.getShortfall(loadBK));
+
+  return t / 60.00;
+}
+
+/* Compare the brew day with the vessels used one after the other and at
+ * the same time. */
+static void concurrent(void)
+{
+  const char *names[] = { "sequential", "concurrent" };
+  double base = 0.00;
+
+  printf("mode        brew-day(min) saved(min) shortfall(%%)\n");
+
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    unsigned int shortfall;
+    double length = runVessels(i != 0, &shortfall);
+
+    if (i == 0)
+    {
+      base = length;
+    }
+
+    printf("%-11s %-13.1f %-10.1f %u\n", names[i], length, base - length,
+           shortfall);
+  }
+}
+
+/* Equal scores are put in grid order, so the ranking is the same however
+ * the runs were spread over the threads. */
+static bool betterScore(const candidate &a, const candidate &b)
+{
+  if (a.score != b.score)
+  {
+    return (a.score < b.score);
+  }
+
+  if (a.kp != b.kp)
+  {
+    return (a.kp < b.kp);
+  }
+
+  if (a.ki != b.ki)
+  {
+    return (a.ki < b.ki);
+  }
+
+  if (a.kd != b.kd)
+  {
+    return (a.kd < b.kd);
+  }
+
+  return (a.window < b.window);
+}
+
+/* Every thread takes the next untried candidate until there are none left.
+ * Candidates are independent, so the index is all the threads share. */
+static void sweepWorker(std::vector<candidate> *candidates,
+                        std::atomic<size_t> *next)
+{
+  for (;;)
+  {
+    size_t i = (*next)++;
+
+    if (i >= candidates->size())
+    {
+      break;
+    }
+
+    runSchedule(&(*candidates)[i]);
+  }
+}
+
+static void sweep(unsigned int threads)
+{
+  std::vector<candidate> candidates;
+
+  for (size_t p = 0; p < SWEEP_COUNT(sweepKp); p++)
+  {
+    for (size_t i = 0; i < SWEEP_COUNT(sweepKi); i++)
+    {
+      for (size_t d = 0; d < SWEEP_COUNT(sweepKd); d++)
+      {
+        for (size_t w = 0; w < SWEEP_COUNT(sweepWindow); w++)
+        {
+          candidate c;
+
+          memset(&c, 0, sizeof(c));
+          c.kp = sweepKp[p];
+          c.ki = sweepKi[i];
+          c.kd = sweepKd[d];
+          c.window = sweepWindow[w];
+
+          candidates.push_back(c);
+        }
+      }
+    }
+  }
+
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    workers.push_back(std::thread(sweepWorker, &candidates, &next));
+  }
+
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    workers[i].join();
+  }
+
+  double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+
+  std::stable_sort(candidates.begin(), candidates.end(), betterScore);
+
+  printf("%lu runs on %u threads in %.2fs, %.1f runs/s\n\n",
+         (unsigned long)(candidates.size()), threads, elapsed,
+         candidates.size() / elapsed);
+
+  printf("kp       ki       kd       window settle(min) overshoot(C) "
+         "in-band rms(C)  score\n");
+
+  for (size_t i = 0; (i < candidates.size()) && (i < 20); i++)
+  {
+    const candidate &c = candidates[i];
+    char window[12] = "burst";
+
+    if (c.window)
+    {
+      snprintf(window, sizeof(window), "%u", c.window);
+    }
+
+    printf("%-8.4f %-8.4f %-8.4f %-6s %-12.2f %-12.3f %-7.3f %-7.4f %.2f\n",
+           c.kp, c.ki, c.kd, window, c.settle, c.overshoot, c.inBand, c.rms,
+           c.score);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  if ((argc == 2) && (strcmp(argv[1], "ripple") == 0))
+  {
+    ripple();
+    return 0;
+  }
+
+  if ((argc == 2) && (strcmp(argv[1], "tune") == 0))
+  {
+    return tune();
+  }
+
+  if ((argc == 2) && (strcmp(argv[1], "schedule") == 0))
+  {
+    schedule();
+    return 0;
+  }
+
+  if ((argc == 2) && (strcmp(argv[1], "concurrent") == 0))
+  {
+    concurrent();
+    return 0;
+  }
+
+  if (((argc == 2) || (argc == 3)) && (strcmp(argv[1], "sweep") == 0))
+  {
+    unsigned int threads = std::thread::hardware_concurrency();
+
+    if (argc == 3)
+    {
+      threads = atoi(argv[2]);
+    }
+
+    if (threads == 0)
+    {
+      threads = 1;
+    }
+
+    sweep(threads);
+    return 0;
+  }
+
+  fprintf(stderr, "usage: %s ripple|tune|schedule|concurrent|sweep [threads]\n", argv[0]);
+  return 1;
+}